@@ -0,0 +1,58 @@
+#include "bench.h"
+
+#include <cstdio>
+
+#include <core/imagepipeline.h>
+#include <core/lutaccuracy.h>
+#include <operator/ocio/colorspace.h>
+#include <operator/ocio/filetransform.h>
+
+
+// Error of the baked LUT against the exact pipeline (gamma encoding of a
+// wide gamut, then a contrast LUT) for each LUT size and shaper, to pick
+// the smallest size meeting a tolerance.
+//
+// Usage : accuracy [samples]
+int BenchAccuracy(const BenchArgs &args)
+{
+    uint32_t samples = ArgOr(args, 0, 1 << 20);
+
+    std::string cube = TempPath("accuracy.cube");
+    std::string config = TempPath("accuracy.ocio");
+    WriteSyntheticCube(cube, 65);
+    WriteSyntheticConfig(config);
+
+    ImagePipeline pipeline;
+    pipeline.SetName("accuracy");
+
+    OCIOColorSpace *csc = pipeline.AddOperator<OCIOColorSpace>();
+    csc->SetConfig(config);
+    csc->GetParameter<SelectParameter>("Source")->setValue("linear");
+    csc->GetParameter<SelectParameter>("Destination")->setValue("gamma");
+
+    OCIOFileTransform *lut = pipeline.AddOperator<OCIOFileTransform>();
+    lut->SetFileTransform(cube);
+
+    auto process = [&pipeline](Image &img) { pipeline.ComputeImage(img); };
+
+    std::printf("%-6s %-6s | %8s %8s | %8s %8s %8s | %8s %8s %8s\n",
+                "Size", "Shaper", "max dE", "mean dE", "max R", "max G", "max B",
+                "bake", "exact", "lut");
+
+    for (LUTShaper shaper : { LUTShaper::Linear, LUTShaper::Log2 })
+        for (uint32_t size : { 17, 33, 65, 129 }) {
+            LUTAccuracy a = MeasureLUTAccuracy(process, size, shaper, samples);
+            const char *name = shaper == LUTShaper::Log2 ? "Log2" : "Linear";
+
+            std::printf("%-6u %-6s | %8.4f %8.4f | %8.5f %8.5f %8.5f | %8.2f %8.2f %8.2f\n",
+                        size, name, a.maxDeltaE, a.meanDeltaE,
+                        a.maxError[0], a.maxError[1], a.maxError[2],
+                        a.bakeTime, a.exactTime, a.lutTime);
+
+            std::string label = "Accuracy " + std::to_string(size) + " " + name;
+            Report(label + " bake", a.bakeTime, uint64_t(size) * size * size);
+            Report(label + " lut apply", a.lutTime, a.samples);
+        }
+
+    return 0;
+}
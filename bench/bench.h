@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <utils/generic.h>
+
+
+class Image;
+
+using BenchArgs = std::vector<std::string>;
+using BenchFunc = FuncT<int(const BenchArgs &args)>;
+
+// Synthetic float RGBA image, smooth ramps over the whole frame with a
+// saturated and an over range area so every operator has work to do.
+Image SyntheticImage(uint32_t w, uint32_t h);
+
+// Path of a generated input in the temporary folder, inputs are written by
+// the benches so they run offline
+std::string TempPath(const std::string &filename);
+
+// Synthetic inputs : a contrast and saturation cube (red fastest), an OCIO
+// config with a gamma encoded wide gamut colorspace and a CTL saturation
+void WriteSyntheticCube(const std::string &path, uint32_t size, float saturation = 1.2f);
+void WriteSyntheticConfig(const std::string &path);
+void WriteSampleCTL(const std::string &path, float saturation = 1.2f);
+
+// Mean time in msec of f() over count iterations, after a warm up run
+double TimeIt(const FuncT<void()> &f, uint32_t count);
+
+// Peak resident memory of the process in MB
+double PeakMemory();
+
+// Integer argument at index, or default value
+uint32_t ArgOr(const BenchArgs &args, size_t index, uint32_t value);
+
+// Prints a timing and keeps it for the JSON report, throughput is given
+// when pixels is not zero
+void Report(const std::string &name, double msec, uint64_t pixels = 0);
+bool WriteJSON(const std::string &path);
+
+int BenchAccuracy(const BenchArgs &args);
+int BenchHalf(const BenchArgs &args);
+int BenchImage(const BenchArgs &args);
+int BenchOperator(const BenchArgs &args);
+int BenchLUT(const BenchArgs &args);
+int BenchRegress(const BenchArgs &args);
@@ -0,0 +1,134 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+#include <sys/resource.h>
+
+#include <core/image.h>
+
+
+Image SyntheticImage(uint32_t w, uint32_t h)
+{
+    Image img = Image::Allocate(w, h, 4);
+
+    float *pix = img.pixels_asfloat();
+    for (uint32_t y = 0; y < h; ++y)
+        for (uint32_t x = 0; x < w; ++x) {
+            float u = 1.f * x / std::max(w - 1, 1u);
+            float v = 1.f * y / std::max(h - 1, 1u);
+            float *p = pix + (uint64_t(y) * w + x) * 4;
+
+            p[0] = u;
+            p[1] = v;
+            p[2] = 0.5f + 0.5f * std::sin(6.2831f * (u + v));
+            p[3] = 1.f;
+
+            // Over range highlights on the right side
+            if (u > 0.9f) {
+                p[0] *= 4.f;
+                p[1] *= 4.f;
+                p[2] *= 4.f;
+            }
+        }
+
+    return img;
+}
+
+std::string TempPath(const std::string &filename)
+{
+    namespace fs = std::filesystem;
+
+    fs::path folder = fs::temp_directory_path() / "elook-bench";
+    fs::create_directories(folder);
+    return (folder / filename).string();
+}
+
+double TimeIt(const FuncT<void()> &f, uint32_t count)
+{
+    using ClockT = std::chrono::steady_clock;
+
+    f();
+
+    auto start = ClockT::now();
+    for (uint32_t i = 0; i < count; ++i)
+        f();
+    std::chrono::duration<double, std::milli> d = ClockT::now() - start;
+
+    return d.count() / std::max(count, 1u);
+}
+
+double PeakMemory()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // Bytes on macOS, kilobytes elsewhere
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1048576.0;
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+uint32_t ArgOr(const BenchArgs &args, size_t index, uint32_t value)
+{
+    if (index >= args.size())
+        return value;
+
+    return std::stoul(args[index]);
+}
+
+struct BenchResult
+{
+    std::string name;
+    double msec;
+    double mpixs;
+};
+
+static std::vector<BenchResult> s_results;
+
+void Report(const std::string &name, double msec, uint64_t pixels)
+{
+    double mpixs = pixels ? 1e-3 * pixels / msec : 0.0;
+    s_results.push_back({ name, msec, mpixs });
+
+    if (pixels)
+        std::printf("%-40s : %9.2f msec, %8.1f Mpix/s\n", name.c_str(), msec, mpixs);
+    else
+        std::printf("%-40s : %9.2f msec\n", name.c_str(), msec);
+}
+
+bool WriteJSON(const std::string &path)
+{
+    std::ofstream ofs(path);
+    if (!ofs)
+        return false;
+
+#ifdef NDEBUG
+    const char *build = "release";
+#else
+    const char *build = "debug";
+#endif
+
+    ofs << std::fixed << std::setprecision(4);
+    ofs << "{\n";
+    ofs << "  \"context\": { \"threads\": " << std::thread::hardware_concurrency()
+        << ", \"build\": \"" << build << "\" },\n";
+    ofs << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < s_results.size(); ++i) {
+        const BenchResult &r = s_results[i];
+        ofs << "    { \"name\": \"" << r.name << "\", \"msec\": " << r.msec
+            << ", \"mpix_per_sec\": " << r.mpixs << " }"
+            << (i + 1 < s_results.size() ? ",\n" : "\n");
+    }
+    ofs << "  ]\n}\n";
+
+    return bool(ofs);
+}
@@ -0,0 +1,59 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <core/image.h>
+#include <operator/ocio/matrix.h>
+
+
+// Throughput of an operator on float and half storage, and error of the
+// half result against the float one.
+//
+// Usage : half [width] [height] [iterations]
+int BenchHalf(const BenchArgs &args)
+{
+    uint32_t w = ArgOr(args, 0, 3840);
+    uint32_t h = ArgOr(args, 1, 2160);
+    uint32_t n = ArgOr(args, 2, 10);
+
+    // Saturation matrix
+    OCIOMatrix op;
+    op.GetParameter<MatrixParameter>("Matrix")->setValue({
+        1.4f, -0.2f, -0.2f, 0.f,
+        -0.2f, 1.4f, -0.2f, 0.f,
+        -0.2f, -0.2f, 1.4f, 0.f,
+        0.f, 0.f, 0.f, 1.f
+    });
+
+    Image src = SyntheticImage(w, h);
+    Image srcHalf = src.to_type(PixelType::Half);
+
+    Image outFloat, outHalf;
+    double tConvert = TimeIt([&]() { outHalf = src.to_type(PixelType::Half); }, n);
+    double tFloat = TimeIt([&]() { outFloat = src; op.Apply(outFloat); }, n);
+    double tHalf = TimeIt([&]() { outHalf = srcHalf; op.Apply(outHalf); }, n);
+
+    // Error against float
+    Image diff = outHalf.to_type(PixelType::Float);
+    const float *a = outFloat.pixels_asfloat();
+    const float *b = diff.pixels_asfloat();
+    double maxAbs = 0.0, maxRel = 0.0;
+    for (uint64_t i = 0; i < outFloat.count() * outFloat.channels(); ++i) {
+        double d = std::abs(a[i] - b[i]);
+        maxAbs = std::max(maxAbs, d);
+        if (std::abs(a[i]) > 1e-3f)
+            maxRel = std::max(maxRel, d / std::abs(a[i]));
+    }
+
+    std::printf("Image          : %ux%u, %u iterations\n", w, h, n);
+    std::printf("Storage        : float %.1f MB, half %.1f MB\n",
+                src.bytes() / 1048576.0, srcHalf.bytes() / 1048576.0);
+    Report("Half convert", tConvert, uint64_t(w) * h);
+    Report("Half apply float", tFloat, uint64_t(w) * h);
+    Report("Half apply half", tHalf, uint64_t(w) * h);
+    std::printf("Max error      : abs %.6f, rel %.6f\n", maxAbs, maxRel);
+
+    return 0;
+}
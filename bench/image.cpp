@@ -0,0 +1,62 @@
+#include "bench.h"
+
+#include <cstdio>
+
+#include <core/image.h>
+
+
+// Decoding of the supported delivery formats at usual resolutions, and the
+// image conversions used along the pipeline.
+//
+// Usage : image [iterations]
+int BenchImage(const BenchArgs &args)
+{
+    uint32_t n = ArgOr(args, 0, 3);
+
+    struct Size { const char *name; uint32_t w, h; };
+    struct Format { const char *ext; PixelType type; };
+
+    const Size sizes[] = { { "2K", 2048, 1080 }, { "4K", 4096, 2160 }, { "8K", 8192, 4320 } };
+    const Format formats[] = { { "exr", PixelType::Half }, { "tif", PixelType::Uint16 }, { "dpx", PixelType::Uint16 } };
+
+    for (auto & s : sizes) {
+        Image src = SyntheticImage(s.w, s.h);
+        uint64_t pixels = src.count();
+
+        for (auto & f : formats) {
+            std::string path = TempPath(std::string("synthetic_") + s.name + "." + f.ext);
+            if (!src.write(path, f.type)) {
+                std::printf("Could not write %s\n", path.c_str());
+                return 1;
+            }
+
+            Image img;
+            double t = TimeIt([&]() { img.read(path); }, n);
+            Report(std::string("Read ") + f.ext + " " + s.name, t, pixels);
+        }
+
+        Image half;
+        Report(std::string("To half ") + s.name,
+               TimeIt([&]() { half = src.to_type(PixelType::Half); }, n), pixels);
+        Report(std::string("To float ") + s.name,
+               TimeIt([&]() { Image tmp = half.to_type(PixelType::Float); }, n), pixels);
+        Report(std::string("To RGB ") + s.name,
+               TimeIt([&]() { Image tmp = src.to_format(PixelFormat::RGB); }, n), pixels);
+        Report(std::string("Resize half ") + s.name,
+               TimeIt([&]() { Image tmp = src.resize(s.w / 2, s.h / 2); }, n), pixels);
+        Report(std::string("Resize box ") + s.name,
+               TimeIt([&]() { Image tmp = src.resize(s.w / 4, s.h / 4, false, "box"); }, n), pixels);
+    }
+
+    for (uint16_t size : { 33, 65 }) {
+        Image lattice;
+        double t = TimeIt([&]() { lattice = Image::Lattice(size); }, n);
+        Report("Lattice " + std::to_string(size), t, lattice.count());
+    }
+
+    Image ramp;
+    double t = TimeIt([&]() { ramp = Image::Ramp1D(8192); }, n);
+    Report("Ramp1D 8192", t, ramp.count());
+
+    return 0;
+}
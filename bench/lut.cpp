@@ -0,0 +1,292 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <core/image.h>
+#include <core/imagepipeline.h>
+#include <core/lutio.h>
+#include <operator/ocio/filetransform.h>
+#include <operator/ocio/operator.h>
+#include <utils/chrono.h>
+
+namespace OCIO = OCIO_NAMESPACE;
+
+
+// Largest difference between a written LUT read back by the file transform
+// operator and the pipeline, at the lattice nodes. Formats limited to
+// [0, 1] are compared to the clamped pipeline output.
+float RoundTripError(const LUT3D &lut, const std::string &path, bool clamped)
+{
+    OCIOFileTransform reader;
+    reader.SetFileTransform(path);
+
+    Image img = Image::Lattice(lut.size());
+    reader.OpApply(img);
+
+    const float *pix = img.pixels_asfloat();
+    const float *ref = lut.data();
+    uint64_t count = uint64_t(lut.size()) * lut.size() * lut.size() * 3;
+
+    float res = 0.f;
+    for (uint64_t i = 0; i < count; ++i) {
+        float expected = clamped ? std::clamp(ref[i], 0.f, 1.f) : ref[i];
+        res = std::max(res, std::abs(pix[i] - expected));
+    }
+
+    return res;
+}
+
+// Table of a .cube file parsed serially with the standard streams, values
+// are correctly rounded as with OCIO
+std::vector<float> ReferenceCube(const std::string &path)
+{
+    std::vector<float> res;
+    std::ifstream ifs(path);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream tokens(line);
+        float v[3];
+        if (tokens >> v[0] >> v[1] >> v[2])
+            res.insert(res.end(), v, v + 3);
+    }
+
+    return res;
+}
+
+// Largest difference between a binary LUT read back and the original
+float BinaryRoundTripError(const LUT3D &lut, const std::string &path)
+{
+    LUT3D read = ReadBinaryLUT(path);
+    if (!read || read.size() != lut.size())
+        return INFINITY;
+
+    float res = 0.f;
+    for (uint64_t i = 0; i < lut.bytes() / sizeof(float); ++i)
+        res = std::max(res, std::abs(read.data()[i] - lut.data()[i]));
+
+    return res;
+}
+
+// Largest difference between a CLF file read back and the original. OCIO
+// v1 does not read CLF, the array (blue fastest) is parsed here.
+float CLFRoundTripError(const LUT3D &lut, const std::string &path)
+{
+    std::ifstream ifs(path);
+    std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    size_t begin = text.find("<Array");
+    begin = begin == std::string::npos ? begin : text.find('>', begin);
+    size_t end = text.find("</Array>");
+    if (begin == std::string::npos || end == std::string::npos || end < begin)
+        return INFINITY;
+
+    std::istringstream tokens(text.substr(begin + 1, end - begin - 1));
+    std::vector<float> values;
+    float v;
+    while (tokens >> v)
+        values.push_back(v);
+
+    uint64_t n = lut.size();
+    if (values.size() != n * n * n * 3)
+        return INFINITY;
+
+    float res = 0.f;
+    for (uint64_t i = 0; i < n * n * n; ++i) {
+        uint64_t b = i % n, g = (i / n) % n, r = i / (n * n);
+        const float *ref = lut.data() + (r + g * n + b * n * n) * 3;
+        for (int k = 0; k < 3; ++k)
+            res = std::max(res, std::abs(values[i * 3 + k] - ref[k]));
+    }
+
+    return res;
+}
+
+// Copy of a .cube file with a TITLE line, comment lines in the header and
+// between entries, or CRLF line endings, variants the native parser must
+// read as OCIO does
+void WriteCubeVariant(const std::string &src, const std::string &dst, const std::string &variant)
+{
+    std::ifstream ifs(src);
+    std::ofstream ofs(dst, std::ios::binary);
+    std::string eol = variant == "crlf" ? "\r\n" : "\n";
+
+    if (variant == "title")
+        ofs << "TITLE \"bench variant\"" << eol;
+    if (variant == "comments")
+        ofs << "# Generated by the lut bench" << eol << "#" << eol;
+
+    std::string line;
+    uint64_t entries = 0;
+    while (std::getline(ifs, line)) {
+        bool entry = !line.empty() && !std::isalpha(static_cast<unsigned char>(line[0]));
+        if (variant == "comments" && entry && entries++ % 1000 == 0)
+            ofs << "  # entry " << entries - 1 << eol;
+        ofs << line << eol;
+    }
+}
+
+// Whether the native .cube parse is bit for bit the LUT OCIO bakes at the
+// cube lattice size, as the file transform does for other formats
+bool CubeMatchesBake(const std::string &path)
+{
+    LUT3D native = ReadCube(path);
+    if (!native)
+        return false;
+
+    OCIO::ClearAllCaches();
+    auto t = OCIO::FileTransform::Create();
+    t->setSrc(path.c_str());
+    t->setInterpolation(OCIO::INTERP_TETRAHEDRAL);
+    auto processor = OCIO::GetCurrentConfig()->getProcessor(t);
+
+    auto process = [&processor](Image &img) { OCIOOperator::ApplyProcessor(processor, img); };
+    LUT3D baked = LUT3D::Bake(process, native.size());
+
+    return baked.size() == native.size()
+        && std::memcmp(baked.data(), native.data(), native.bytes()) == 0;
+}
+
+// 3D LUT export of a pipeline : lattice compute, then writing of each
+// format. Formats OCIO reads back are checked against the pipeline, CLF and
+// binary files against the baked LUT, a dark LUT as well except for .3dl
+// (OCIO v1 guesses its output depth from the values). Then LUT file loads, first one parsed by OCIO
+// and later ones from the binary cache, .cube files being parsed natively :
+// native parses must match the OCIO bake bit for bit.
+//
+// Usage : lut [iterations]
+int BenchLUT(const BenchArgs &args)
+{
+    uint32_t n = ArgOr(args, 0, 3);
+
+    std::string cube = TempPath("lut_source.cube");
+    WriteSyntheticCube(cube, 65);
+
+    ImagePipeline pipeline;
+    pipeline.SetName("bench");
+    OCIOFileTransform *op = pipeline.AddOperator<OCIOFileTransform>();
+    op->SetFileTransform(cube);
+
+    struct Check { LUTFormat format; std::string ext; bool dark; bool clamped; float tolerance; };
+    const Check checks[] = {
+        { LUTFormat::Cube, "cube", true, false, 1e-5f },
+        { LUTFormat::Spi3D, "spi3d", true, false, 1e-5f },
+        { LUTFormat::ThreeDL, "3dl", false, true, 2e-5f },
+        { LUTFormat::CLF, "clf", true, false, 1e-5f },
+        { LUTFormat::Binary, "elut", true, false, 0.f },
+    };
+
+    auto roundTripError = [](const Check &c, const LUT3D &lut, const std::string &path) {
+        if (c.format == LUTFormat::Binary)
+            return BinaryRoundTripError(lut, path);
+        if (c.format == LUTFormat::CLF)
+            return CLFRoundTripError(lut, path);
+        return RoundTripError(lut, path, c.clamped);
+    };
+
+    uint32_t failures = 0;
+    for (uint32_t size : { 17, 33, 65, 129 }) {
+        uint64_t entries = uint64_t(size) * size * size;
+
+        LUT3D lut;
+        double t = TimeIt([&]() { lut = pipeline.BakeLUT(size); }, n);
+        Report("Bake " + std::to_string(size), t, entries);
+
+        // Dark LUT (largest output 0.05), for readers guessing the output
+        // range from the values
+        LUT3D dark = lut;
+        float *values = dark.data();
+        uint64_t count = dark.bytes() / sizeof(float);
+        float top = *std::max_element(values, values + count);
+        std::transform(values, values + count, values, [top](float v) { return v * 0.05f / top; });
+
+        for (auto & c : checks) {
+            const std::string &ext = c.ext;
+            std::string path = TempPath("export_" + std::to_string(size) + "." + ext);
+
+            t = TimeIt([&]() { WriteLUT(lut, path, c.format); }, n);
+            Report("Write " + ext + " " + std::to_string(size), t, entries);
+
+            float error = roundTripError(c, lut, path);
+            std::printf("  %s : round trip error %.7f (max %.7f)\n",
+                        error <= c.tolerance ? "PASS" : "FAIL", error, c.tolerance);
+            if (error > c.tolerance)
+                failures++;
+
+            if (!c.dark)
+                continue;
+
+            std::string darkPath = TempPath("export_dark_" + std::to_string(size) + "." + ext);
+            WriteLUT(dark, darkPath, c.format);
+            error = roundTripError(c, dark, darkPath);
+            std::printf("  %s : dark round trip error %.7f (max %.7f)\n",
+                        error <= c.tolerance ? "PASS" : "FAIL", error, c.tolerance);
+            if (error > c.tolerance)
+                failures++;
+        }
+
+        // Resampling to the common look library sizes, error measured at
+        // the source nodes
+        for (uint32_t target : { 17, 33, 65 }) {
+            if (target == size)
+                continue;
+
+            LUT3D res;
+            uint64_t nodes = uint64_t(target) * target * target;
+            t = TimeIt([&]() { res = lut.resample(target); }, n);
+            Report("Resample " + std::to_string(size) + " to " + std::to_string(target), t, nodes);
+            std::printf("  resample error %.7f\n", lut.difference(res));
+        }
+    }
+
+    for (uint32_t size : { 17, 33, 65 }) {
+        std::string name = std::to_string(size);
+        std::string path = TempPath("load_" + name + ".cube");
+        WriteSyntheticCube(path, size);
+
+        // Native parser against OCIO parsing (processor creation)
+        LUT3D native;
+        Report("Read cube " + name + " native", TimeIt([&]() { native = ReadCube(path); }, n));
+        Report("Read cube " + name + " OCIO", TimeIt([&]() {
+            OCIO::ClearAllCaches();
+            auto t = OCIO::FileTransform::Create();
+            t->setSrc(path.c_str());
+            t->setInterpolation(OCIO::INTERP_TETRAHEDRAL);
+            OCIO::GetCurrentConfig()->getProcessor(t);
+        }, n));
+
+        bool exact = native && ReferenceCube(path) == std::vector<float>(native.data(), native.data() + native.bytes() / sizeof(float));
+        std::printf("  %s : native values match the reference parse\n", exact ? "PASS" : "FAIL");
+        if (!exact)
+            failures++;
+
+        for (const char *variant : { "plain", "crlf", "title", "comments" }) {
+            std::string file = TempPath("load_" + name + "_" + variant + ".cube");
+            WriteCubeVariant(path, file, variant);
+            bool match = CubeMatchesBake(file);
+            std::printf("  %s : native %s cube matches the OCIO bake\n", match ? "PASS" : "FAIL", variant);
+            if (!match)
+                failures++;
+        }
+
+        // Other formats go through OCIO once, then the binary cache
+        std::string other = TempPath("load_" + name + ".spi3d");
+        WriteLUT(native, other, LUTFormat::Spi3D);
+        std::remove(LUTCachePath(other).c_str());
+
+        OCIOFileTransform load;
+        Chrono c;
+        c.start();
+        load.SetFileTransform(other);
+        Report("Load spi3d " + name + " parse", c.ellapsed(Chrono::MILLISECONDS));
+        Report("Load spi3d " + name + " cached", TimeIt([&]() { load.SetFileTransform(other); }, n));
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "bench.h"
+
+
+int main(int argc, char **argv)
+{
+    std::map<std::string, BenchFunc> benches = {
+        { "accuracy", BenchAccuracy },
+        { "half", BenchHalf },
+        { "image", BenchImage },
+        { "operator", BenchOperator },
+        { "lut", BenchLUT },
+        { "regress", BenchRegress },
+    };
+
+    // Every bench with its default arguments, regressions need a golden
+    // folder and are run on their own
+    benches["all"] = [&benches](const BenchArgs &) {
+        int res = 0;
+        for (auto & b : benches)
+            if (b.first != "all" && b.first != "regress")
+                res |= b.second({});
+        return res;
+    };
+
+    auto it = argc > 1 ? benches.find(argv[1]) : benches.end();
+    if (it == benches.end()) {
+        std::printf("Usage : %s <bench> [args...] [--json <file>]\n\nBenches :\n", argv[0]);
+        for (auto & b : benches)
+            std::printf("  %s\n", b.first.c_str());
+        return 1;
+    }
+
+    // Results are also written as JSON, to track regressions across builds
+    BenchArgs args(argv + 2, argv + argc);
+    std::string json;
+    auto j = std::find(args.begin(), args.end(), "--json");
+    if (j != args.end() && j + 1 != args.end()) {
+        json = *(j + 1);
+        args.erase(j, j + 2);
+    }
+
+    int res = it->second(args);
+
+    if (!json.empty() && !WriteJSON(json)) {
+        std::printf("Could not write %s\n", json.c_str());
+        return 1;
+    }
+
+    return res;
+}
@@ -0,0 +1,147 @@
+#include "bench.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include <core/image.h>
+#include <operator/ocio/matrix.h>
+#include <operator/ocio/filetransform.h>
+#include <operator/ocio/colorspace.h>
+#include <operator/ctl/operator.h>
+
+
+void WriteSyntheticCube(const std::string &path, uint32_t size, float saturation)
+{
+    std::ofstream ofs(path);
+    ofs << "LUT_3D_SIZE " << size << "\n\n";
+
+    for (uint32_t b = 0; b < size; ++b)
+        for (uint32_t g = 0; g < size; ++g)
+            for (uint32_t r = 0; r < size; ++r) {
+                float rgb[3] = { 1.f * r / (size - 1), 1.f * g / (size - 1), 1.f * b / (size - 1) };
+                float luma = 0.2126f * rgb[0] + 0.7152f * rgb[1] + 0.0722f * rgb[2];
+                for (float & v : rgb) {
+                    v = luma + saturation * (v - luma);
+                    v = v * v * (3.f - 2.f * v);
+                }
+                ofs << rgb[0] << " " << rgb[1] << " " << rgb[2] << "\n";
+            }
+}
+
+void WriteSyntheticConfig(const std::string &path)
+{
+    std::ofstream ofs(path);
+    ofs << "ocio_profile_version: 1\n"
+           "search_path: .\n"
+           "strictparsing: true\n"
+           "roles:\n"
+           "  default: linear\n"
+           "  scene_linear: linear\n"
+           "displays:\n"
+           "  default:\n"
+           "    - !<View> {name: Gamma, colorspace: gamma}\n"
+           "active_displays: []\n"
+           "active_views: []\n"
+           "colorspaces:\n"
+           "  - !<ColorSpace>\n"
+           "    name: linear\n"
+           "    bitdepth: 32f\n"
+           "    isdata: false\n"
+           "  - !<ColorSpace>\n"
+           "    name: gamma\n"
+           "    bitdepth: 32f\n"
+           "    isdata: false\n"
+           "    to_reference: !<GroupTransform>\n"
+           "      children:\n"
+           "        - !<ExponentTransform> {value: [2.4, 2.4, 2.4, 1]}\n"
+           "        - !<MatrixTransform> {matrix: [0.6274, 0.3293, 0.0433, 0, 0.0691, 0.9195, 0.0114, 0, 0.0164, 0.0880, 0.8956, 0, 0, 0, 0, 1]}\n";
+}
+
+void WriteSampleCTL(const std::string &path, float saturation)
+{
+    std::ofstream ofs(path);
+    ofs << "void main(input varying float rIn, input varying float gIn, input varying float bIn,\n"
+           "          input varying float aIn,\n"
+           "          output varying float rOut, output varying float gOut, output varying float bOut,\n"
+           "          output varying float aOut)\n"
+           "{\n"
+           "    float luma = 0.2126 * rIn + 0.7152 * gIn + 0.0722 * bIn;\n"
+           "    rOut = luma + " << saturation << " * (rIn - luma);\n"
+           "    gOut = luma + " << saturation << " * (gIn - luma);\n"
+           "    bOut = luma + " << saturation << " * (bIn - luma);\n"
+           "    aOut = aIn;\n"
+           "}\n";
+}
+
+// Each operator implementation on its own (OpApply), then the generic
+// ImageOperator::Apply with the opacity and contrast / color isolation
+// mixes. CTL is interpreted and much slower, it runs on a quarter of the
+// frame.
+//
+// Usage : operator [width] [height] [iterations]
+int BenchOperator(const BenchArgs &args)
+{
+    uint32_t w = ArgOr(args, 0, 3840);
+    uint32_t h = ArgOr(args, 1, 2160);
+    uint32_t n = ArgOr(args, 2, 10);
+
+    Image src = SyntheticImage(w, h);
+    Image img;
+
+    auto bench = [&](const std::string &name, ImageOperator &op, const Image &input, bool generic) {
+        double t = TimeIt([&]() {
+            img = input;
+            if (generic)
+                op.Apply(img);
+            else
+                op.OpApply(img);
+        }, n);
+        Report(name, t, input.count());
+    };
+
+    OCIOMatrix matrix;
+    matrix.GetParameter<MatrixParameter>("Matrix")->setValue({
+        1.4f, -0.2f, -0.2f, 0.f,
+        -0.2f, 1.4f, -0.2f, 0.f,
+        -0.2f, -0.2f, 1.4f, 0.f,
+        0.f, 0.f, 0.f, 1.f
+    });
+    bench("OpApply OCIO Matrix", matrix, src, false);
+
+    std::string cube = TempPath("synthetic.cube");
+    WriteSyntheticCube(cube, 33);
+    OCIOFileTransform file;
+    file.SetFileTransform(cube);
+    bench("OpApply OCIO File Transform", file, src, false);
+
+    std::string config = TempPath("synthetic.ocio");
+    WriteSyntheticConfig(config);
+    OCIOColorSpace colorspace;
+    colorspace.SetConfig(config);
+    colorspace.GetParameter<SelectParameter>("Source")->setValue("gamma");
+    colorspace.GetParameter<SelectParameter>("Destination")->setValue("linear");
+    bench("OpApply OCIO ColorSpace", colorspace, src, false);
+
+    std::string ctl = TempPath("sample.ctl");
+    WriteSampleCTL(ctl);
+    CTLTransform ctlTransform;
+    ctlTransform.GetParameter<FilePathParameter>("CTL File")->setValue(ctl);
+    bench("OpApply CTL Transform", ctlTransform, src.resize(w / 2, h / 2, false), false);
+
+    // Mixing paths of the generic apply
+    bench("Apply", file, src, true);
+
+    file.GetParameter<SliderParameter>("Opacity")->setValue(50.f);
+    bench("Apply opacity", file, src, true);
+    file.GetParameter<SliderParameter>("Opacity")->setValue(100.f);
+
+    file.GetParameter<SliderParameter>("Contrast")->setValue(0.f);
+    bench("Apply color only", file, src, true);
+
+    file.GetParameter<SliderParameter>("Contrast")->setValue(50.f);
+    file.GetParameter<SliderParameter>("Color")->setValue(50.f);
+    bench("Apply contrast and color mix", file, src, true);
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include <core/image.h>
+#include <core/imagepipeline.h>
+#include <operator/ocio/filetransform.h>
+#include <operator/ocio/colorspace.h>
+#include <operator/ctl/operator.h>
+#include <utils/chrono.h>
+
+namespace fs = std::filesystem;
+
+
+// Runs of each case, the time checked against the budget is their median
+constexpr uint32_t RegressRuns = 5;
+
+// Exit code of a run without goldens, reported as skipped by CTest
+constexpr int RegressSkipped = 77;
+
+struct RegressCase
+{
+    std::string name;
+    FuncT<Image()> run;
+};
+
+// Per case limits, one line per case : name time memory(MB) tolerance.
+// Time is relative to the calibration run, so that budgets recorded on one
+// machine hold on others.
+struct RegressBudget
+{
+    double time;
+    double memory;
+    double tolerance;
+};
+
+std::map<std::string, RegressBudget> ReadBudgets(const std::string &path)
+{
+    std::map<std::string, RegressBudget> res;
+
+    std::ifstream ifs(path);
+    std::string name;
+    RegressBudget b;
+    while (ifs >> name >> b.time >> b.memory >> b.tolerance)
+        res[name] = b;
+
+    return res;
+}
+
+bool WriteBudgets(const std::string &path, const std::map<std::string, RegressBudget> &budgets)
+{
+    std::ofstream ofs(path);
+    for (auto & [name, b] : budgets)
+        ofs << name << " " << b.time << " " << b.memory << " " << b.tolerance << "\n";
+
+    return bool(ofs);
+}
+
+// Largest absolute difference over the common channels, infinite when the
+// images do not match in size
+double MaxDifference(const Image &a, const Image &b)
+{
+    if (!a || !b || a.width() != b.width() || a.height() != b.height())
+        return INFINITY;
+
+    Image fa = a.to_type(PixelType::Float);
+    Image fb = b.to_type(PixelType::Float);
+    const float *pa = fa.pixels_asfloat();
+    const float *pb = fb.pixels_asfloat();
+    uint8_t channels = std::min(fa.channels(), fb.channels());
+
+    double res = 0.0;
+    for (uint64_t i = 0; i < fa.count(); ++i)
+        for (uint8_t c = 0; c < channels; ++c)
+            res = std::max(res, double(std::abs(pa[i * fa.channels() + c] - pb[i * fb.channels() + c])));
+
+    return res;
+}
+
+// Median time of a fixed workload (resize and conversions of a synthetic
+// frame), the unit of the time budgets
+double CalibrationTime()
+{
+    Image src = SyntheticImage(1920, 1080);
+
+    std::vector<double> times;
+    for (uint32_t i = 0; i < RegressRuns; ++i) {
+        Chrono chrono;
+        chrono.start();
+        Image img = src.resize(960, 540, false).to_type(PixelType::Half).to_type(PixelType::Float);
+        times.push_back(chrono.ellapsed(Chrono::MILLISECONDS));
+    }
+
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return std::max(times[times.size() / 2], 1e-3);
+}
+
+// End to end checks of canned pipelines : outputs are compared to golden
+// images, run time and peak memory to the budgets stored alongside
+// (budgets.txt). With --update, goldens and budgets are (re)written from
+// the current build, budgets with a 50% margin on the median time and 25%
+// on memory. The colour tolerance and memory are hard limits, time is
+// only reported since it depends on the machine load. Without goldens the
+// run is skipped. The check is registered as the "regress" test, reading
+// bench/golden.
+//
+// Peak memory is the process peak so far, cases are run from the smallest
+// to the largest footprint.
+//
+// Usage : regress <golden folder> [--update]
+int BenchRegress(const BenchArgs &args)
+{
+    if (args.empty()) {
+        std::printf("Usage : regress <golden folder> [--update]\n");
+        return 1;
+    }
+
+    std::string folder = args[0];
+    bool update = std::find(args.begin(), args.end(), "--update") != args.end();
+    std::string budgetPath = (fs::path(folder) / "budgets.txt").string();
+
+    if (update) {
+        fs::create_directories(folder);
+    }
+    else if (!fs::exists(budgetPath)) {
+        std::printf("No goldens in %s, skipped (record them with --update)\n", folder.c_str());
+        return RegressSkipped;
+    }
+
+    double calibration = CalibrationTime();
+    Report("Regress calibration", calibration);
+
+    // Inputs
+    Image src = SyntheticImage(1920, 1080);
+
+    std::string cube = TempPath("regress.cube");
+    std::string config = TempPath("regress.ocio");
+    std::string ctlA = TempPath("regress_a.ctl");
+    std::string ctlB = TempPath("regress_b.ctl");
+    WriteSyntheticCube(cube, 33);
+    WriteSyntheticConfig(config);
+    WriteSampleCTL(ctlA, 1.2f);
+    WriteSampleCTL(ctlB, 0.9f);
+
+    std::vector<std::string> looks;
+    for (uint32_t i = 0; i < 200; ++i) {
+        looks.push_back(TempPath("regress_look_" + std::to_string(i) + ".cube"));
+        WriteSyntheticCube(looks.back(), 17, 0.5f + i / 100.f);
+    }
+
+    auto csc = [&config]() {
+        auto op = new OCIOColorSpace();
+        op->SetConfig(config);
+        op->GetParameter<SelectParameter>("Source")->setValue("linear");
+        op->GetParameter<SelectParameter>("Destination")->setValue("gamma");
+        return op;
+    };
+    auto lut = [](const std::string &path) {
+        auto op = new OCIOFileTransform();
+        op->SetFileTransform(path);
+        return op;
+    };
+    auto ctl = [](const std::string &path) {
+        auto op = new CTLTransform();
+        op->GetParameter<FilePathParameter>("CTL File")->setValue(path);
+        return op;
+    };
+
+    std::vector<RegressCase> cases;
+
+    cases.push_back({ "csc_lut", [&]() {
+        ImagePipeline p;
+        p.AddOperator(csc());
+        p.AddOperator(lut(cube));
+
+        Image img = src;
+        p.ComputeImage(img);
+        return img;
+    }});
+
+    // Chain of CTL transforms as in an ACES RRT / ODT chain, the ACES
+    // reference scripts are not bundled
+    cases.push_back({ "ctl_chain", [&]() {
+        ImagePipeline p;
+        p.AddOperator(ctl(ctlA));
+        p.AddOperator(ctl(ctlB));
+
+        Image img = src.resize(480, 270, false);
+        p.ComputeImage(img);
+        return img;
+    }});
+
+    cases.push_back({ "isolation", [&]() {
+        ImagePipeline p;
+        ImageOperator *op = p.AddOperator(lut(cube));
+        op->GetParameter<SliderParameter>("Contrast")->setValue(50.f);
+        op->GetParameter<SliderParameter>("Color")->setValue(70.f);
+        op->GetParameter<SliderParameter>("Opacity")->setValue(80.f);
+
+        Image img = src;
+        p.ComputeImage(img);
+        return img;
+    }});
+
+    // Look tab thumbnails, one pipeline where the look is replaced, results
+    // are gathered in a contact sheet
+    cases.push_back({ "thumbnails", [&]() {
+        const uint32_t tw = 128, th = 72, columns = 20;
+        Image thumb = src.resize(tw, th, false);
+        Image sheet = Image::Allocate(tw * columns, th * ((looks.size() + columns - 1) / columns), thumb.channels());
+
+        ImagePipeline p;
+        p.AddOperator(lut(looks[0]));
+        for (uint32_t i = 0; i < looks.size(); ++i) {
+            p.ReplaceOperator(lut(looks[i]), 0);
+
+            Image img = thumb;
+            p.ComputeImage(img);
+            sheet.paste(img, (i % columns) * tw, (i / columns) * th);
+        }
+
+        return sheet;
+    }});
+
+    std::map<std::string, RegressBudget> budgets = ReadBudgets(budgetPath);
+
+    uint32_t failures = 0;
+    for (auto & c : cases) {
+        Image out;
+        std::vector<double> times;
+        for (uint32_t i = 0; i < RegressRuns; ++i) {
+            Chrono chrono;
+            chrono.start();
+            out = c.run();
+            times.push_back(chrono.ellapsed(Chrono::MILLISECONDS));
+        }
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        double msec = times[times.size() / 2];
+        double memory = PeakMemory();
+        Report("Regress " + c.name, msec, out.count());
+
+        std::string golden = (fs::path(folder) / (c.name + ".exr")).string();
+        if (update) {
+            out.write(golden, PixelType::Float);
+            budgets[c.name] = { msec / calibration * 1.5, memory * 1.25, 1e-3 };
+            continue;
+        }
+
+        auto b = budgets.find(c.name);
+        if (b == budgets.end()) {
+            std::printf("  FAIL : no budget, run with --update first\n");
+            failures++;
+            continue;
+        }
+
+        double diff = MaxDifference(out, Image::FromFile(golden));
+        double time = msec / calibration;
+        bool accurate = diff <= b->second.tolerance;
+        bool fast = time <= b->second.time;
+        bool small = memory <= b->second.memory;
+
+        std::printf("  %s : difference %.6f (max %.6f), %.2f x calibration (max %.2f%s), %.1f MB (max %.1f)\n",
+                    accurate && small ? "PASS" : "FAIL",
+                    diff, b->second.tolerance, time, b->second.time, fast ? "" : ", SLOW",
+                    memory, b->second.memory);
+        if (!accurate || !small)
+            failures++;
+    }
+
+    if (update) {
+        if (!WriteBudgets(budgetPath, budgets)) {
+            std::printf("Could not write %s\n", budgetPath.c_str());
+            return 1;
+        }
+        std::printf("Goldens and budgets updated in %s\n", folder.c_str());
+        return 0;
+    }
+
+    std::printf("%zu cases, %u failed\n", cases.size(), failures);
+    return failures ? 1 : 0;
+}
@@ -12,7 +12,8 @@ Context& Context::getInstance()
 Context::Context() :
     m_settings(new ParameterSerialList()),
     m_pipeline(new ImagePipeline()),
-    m_operators(new ImageOperatorList())
+    m_operators(new ImageOperatorList()),
+    m_resultCache(new ResultCache())
 {
 
 }
@@ -23,6 +24,8 @@ ImagePipeline& Context::pipeline() { return *m_pipeline; }
 
 ImageOperatorList& Context::operators() { return *m_operators; }
 
+ResultCache& Context::resultCache() { return *m_resultCache; }
+
 QStringList Context::supportedLookExtensions()
 {
     QStringList res;
@@ -5,6 +5,7 @@
 #include <utils/generic.h>
 #include <parameter/parameterseriallist.h>
 #include <core/imagepipeline.h>
+#include <core/resultcache.h>
 #include <operator/imageoperatorlist.h>
 
 
@@ -23,6 +24,7 @@ class Context
     ParameterSerialList& settings();
     ImagePipeline& pipeline();
     ImageOperatorList& operators();
+    ResultCache& resultCache();
 
     QStringList supportedLookExtensions();
 
@@ -30,4 +32,5 @@ class Context
     UPtr<ParameterSerialList> m_settings;
     UPtr<ImagePipeline> m_pipeline;
     UPtr<ImageOperatorList> m_operators;
+    UPtr<ResultCache> m_resultCache;
 };
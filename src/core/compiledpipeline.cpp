@@ -0,0 +1,434 @@
+#include "compiledpipeline.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtCore/QDebug>
+
+#include <operator/imageoperator.h>
+#include <operator/ocio/operator.h>
+#include <utils/parallel.h>
+#include <utils/trace.h>
+
+#include "image.h"
+
+namespace OCIO = OCIO_NAMESPACE;
+
+
+// Generic Contrast / Color isolation mixes the operator result in a way
+// that cannot be folded, Opacity is a simple mix with the input.
+bool HasIsolation(ImageOperator *op)
+{
+    return op->GetParameter<SliderParameter>("Contrast")->value() != 100.f
+        || op->GetParameter<SliderParameter>("Color")->value() != 100.f;
+}
+
+// OpenColorIO operator whose result is exactly its processor output
+OCIOOperator *FoldableOCIO(ImageOperator *op)
+{
+    auto ocio = dynamic_cast<OCIOOperator *>(op);
+    if (!ocio || !ocio->OpFoldable() || HasIsolation(op) || op->GetParameter<SliderParameter>("Opacity")->value() != 100.f)
+        return nullptr;
+
+    return ocio;
+}
+
+// Operator expressible as a matrix or a per-channel curve
+bool Decomposable(ImageOperator *op)
+{
+    return op->OpNeighbourhood() == 0 && !HasIsolation(op)
+        && (op->OpMatrix() || op->OpIsPerChannel());
+}
+
+// Config shared by two adjacent operators, or null when they conflict.
+// Operators not referring to their config content can use any config.
+OCIO::ConstConfigRcPtr SharedConfig(OCIO::ConstConfigRcPtr config, bool needsConfig, const OCIOOperator *op)
+{
+    if (!op->OpNeedsConfig())
+        return config;
+    if (!needsConfig || config == op->Config())
+        return op->Config();
+    return OCIO::ConstConfigRcPtr();
+}
+
+Matrix4x4 MultiplyMatrix(const Matrix4x4 &a, const Matrix4x4 &b)
+{
+    Matrix4x4 m;
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c) {
+            m[r * 4 + c] = 0.f;
+            for (int k = 0; k < 4; ++k)
+                m[r * 4 + c] += a[r * 4 + k] * b[k * 4 + c];
+        }
+    return m;
+}
+
+// Number of samples of the curve tables
+constexpr uint32_t CurveTableSize = CompiledPipeline::CurveSize + CompiledPipeline::CurveLogSize;
+
+// Input value of a curve table sample, the log segment starts at the last
+// linear sample (1.0)
+float CurveSample(uint32_t i)
+{
+    const uint32_t n = CompiledPipeline::CurveSize;
+    if (i < n)
+        return float(i) / (n - 1);
+
+    return std::exp2(float(i - (n - 1)) * CompiledPipeline::CurveStops / CompiledPipeline::CurveLogSize);
+}
+
+// Table interval holding a value and the position within it, negative,
+// too large or NaN values are outside the tables
+bool CurvePosition(float v, uint32_t &i, float &t)
+{
+    const uint32_t n = CompiledPipeline::CurveSize;
+    const uint32_t m = CompiledPipeline::CurveLogSize;
+    const float top = float(1u << CompiledPipeline::CurveStops);
+
+    if (v >= 0.f && v <= 1.f) {
+        float f = v * (n - 1);
+        i = std::min(uint32_t(f), n - 2);
+        t = f - i;
+        return true;
+    }
+
+    if (v > 1.f && v <= top) {
+        float f = std::log2(v) / CompiledPipeline::CurveStops * m;
+        uint32_t j = std::min(uint32_t(f), m - 1);
+        i = n - 1 + j;
+        t = f - j;
+        return true;
+    }
+
+    return false;
+}
+
+// Folded kernel, either a matrix or RGB curves tabulated over the curve
+// samples (see CurveSample)
+struct AlgebraicStage
+{
+    bool curve = false;
+    Matrix4x4 matrix;
+    std::vector<float> table;
+};
+
+// Applies folded stages in a single traversal. Curves are defined over
+// [0, 2^CurveStops], pixels leaving this domain are gathered and processed
+// exactly by the original operators.
+void ApplyStages(const std::vector<AlgebraicStage> &stages,
+                 const std::vector<ImageOperator *> &operators, Image &img)
+{
+    uint8_t c = img.channels();
+    if (c < 3) {
+        for (auto op : operators)
+            op->Apply(img);
+        return;
+    }
+
+    uint32_t w = img.width();
+    uint32_t h = img.height();
+    float *pixels = img.pixels_asfloat();
+
+    std::vector<std::vector<uint32_t>> outside(h);
+
+    ParallelFor(0, h, [&](int64_t ybegin, int64_t yend) {
+        for (int64_t y = ybegin; y < yend; ++y) {
+            float *row = pixels + uint64_t(y) * w * c;
+            for (uint32_t x = 0; x < w; ++x) {
+                float *p = row + uint64_t(x) * c;
+                float v[4] = { p[0], p[1], p[2], c > 3 ? p[3] : 0.f };
+                bool inside = true;
+
+                for (auto & s : stages) {
+                    if (s.curve) {
+                        for (int k = 0; k < 3 && inside; ++k) {
+                            uint32_t i;
+                            float t;
+                            if (!CurvePosition(v[k], i, t)) {
+                                inside = false;
+                                break;
+                            }
+                            v[k] = s.table[i * 3 + k] * (1.f - t) + s.table[(i + 1) * 3 + k] * t;
+                        }
+                        if (!inside)
+                            break;
+                    }
+                    else {
+                        const Matrix4x4 & m = s.matrix;
+                        float r[4];
+                        for (int k = 0; k < 4; ++k)
+                            r[k] = m[k * 4] * v[0] + m[k * 4 + 1] * v[1] + m[k * 4 + 2] * v[2] + m[k * 4 + 3] * v[3];
+                        std::copy(r, r + 4, v);
+                    }
+                }
+
+                if (!inside) {
+                    outside[y].push_back(x);
+                    continue;
+                }
+
+                std::copy(v, v + c, p);
+            }
+        }
+    }, 16);
+
+    uint64_t count = 0;
+    for (auto & row : outside)
+        count += row.size();
+    if (count == 0)
+        return;
+
+    // Untouched pixels still hold their input values
+    Image exact = Image::Allocate(count, 1, c);
+    float *e = exact.pixels_asfloat();
+    for (uint32_t y = 0; y < h; ++y)
+        for (uint32_t x : outside[y]) {
+            std::copy_n(pixels + (uint64_t(y) * w + x) * c, c, e);
+            e += c;
+        }
+
+    for (auto op : operators)
+        op->Apply(exact);
+
+    e = exact.pixels_asfloat();
+    for (uint32_t y = 0; y < h; ++y)
+        for (uint32_t x : outside[y]) {
+            std::copy_n(e, c, pixels + (uint64_t(y) * w + x) * c);
+            e += c;
+        }
+}
+
+// Largest error of folded stages against the operators, between the
+// curve samples where interpolation error peaks. Channels walk the tables
+// at different rates so that matrices see uncorrelated values.
+float FoldError(const std::vector<AlgebraicStage> &stages, const std::vector<ImageOperator *> &operators)
+{
+    const uint32_t count = CurveTableSize - 1;
+    Image exact = Image::Allocate(count, 1, 3);
+    float *e = exact.pixels_asfloat();
+    for (uint32_t i = 0; i < count; ++i)
+        for (uint32_t k = 0; k < 3; ++k) {
+            uint32_t j = (uint64_t(i) * (1 + 6 * k)) % count;
+            e[i * 3 + k] = 0.5f * (CurveSample(j) + CurveSample(j + 1));
+        }
+
+    Image folded = exact;
+    for (auto op : operators)
+        op->Apply(exact);
+    ApplyStages(stages, operators, folded);
+
+    const float *a = exact.pixels_asfloat();
+    const float *b = folded.pixels_asfloat();
+    float res = 0.f;
+    for (uint64_t i = 0; i < uint64_t(count) * 3; ++i) {
+        float d = std::abs(a[i] - b[i]) / std::max(1.f, std::abs(a[i]));
+        if (std::isnan(d))
+            d = std::isnan(a[i]) && std::isnan(b[i]) ? 0.f : INFINITY;
+        res = std::max(res, d);
+    }
+
+    return res;
+}
+
+void CompiledPipeline::Compile(const UPtrV<ImageOperator> &operators)
+{
+    m_passes.clear();
+
+    std::vector<ImageOperator *> run;
+    for (auto & op : operators) {
+        if (op->IsIdentity())
+            continue;
+
+        if (FoldableOCIO(op.get()) || Decomposable(op.get())) {
+            run.push_back(op.get());
+            continue;
+        }
+
+        FoldRun(run);
+        run.clear();
+
+        AddOperatorPass(op.get());
+    }
+
+    FoldRun(run);
+
+    if (Eliminated() > 0)
+        qInfo() << "Compile pipeline :" << int(OperatorCount()) << "operators in"
+                << int(PassCount()) << "passes," << int(Eliminated()) << "eliminated\n";
+}
+
+void CompiledPipeline::FoldRun(const std::vector<ImageOperator *> &operators)
+{
+    if (operators.size() > 1 && std::all_of(operators.begin(), operators.end(), Decomposable)) {
+        FoldAlgebraic(operators);
+        return;
+    }
+
+    // Split in groups of OCIO operators sharing a config
+    std::vector<ImageOperator *> group;
+    OCIO::ConstConfigRcPtr groupConfig;
+    bool groupNeedsConfig = false;
+
+    for (auto op : operators) {
+        OCIOOperator *ocio = FoldableOCIO(op);
+        OCIO::ConstConfigRcPtr config;
+        if (ocio && !group.empty())
+            config = SharedConfig(groupConfig, groupNeedsConfig, ocio);
+
+        if (!ocio || (!group.empty() && !config)) {
+            FoldOCIO(group);
+            group.clear();
+        }
+
+        if (!ocio) {
+            AddOperatorPass(op);
+            continue;
+        }
+
+        if (group.empty()) {
+            groupConfig = ocio->Config();
+            groupNeedsConfig = ocio->OpNeedsConfig();
+        }
+        else {
+            groupConfig = config;
+            groupNeedsConfig |= ocio->OpNeedsConfig();
+        }
+        group.push_back(ocio);
+    }
+
+    FoldOCIO(group);
+}
+
+void CompiledPipeline::FoldAlgebraic(const std::vector<ImageOperator *> &operators)
+{
+    std::vector<AlgebraicStage> stages;
+
+    for (auto op : operators) {
+        float a = op->GetParameter<SliderParameter>("Opacity")->value() / 100.f;
+
+        if (OptT<Matrix4x4> m = op->OpMatrix()) {
+            // Opacity mix with the input : (1 - a) * I + a * M
+            Matrix4x4 mix = *m;
+            for (int i = 0; i < 16; ++i)
+                mix[i] = a * mix[i] + (i % 5 == 0 ? 1.f - a : 0.f);
+
+            if (!stages.empty() && !stages.back().curve) {
+                stages.back().matrix = MultiplyMatrix(mix, stages.back().matrix);
+            }
+            else {
+                AlgebraicStage s;
+                s.matrix = mix;
+                stages.push_back(std::move(s));
+            }
+            continue;
+        }
+
+        // Curves are composed by applying the operator to the previous
+        // table values, which is exact at every sample
+        Image samples = Image::Allocate(CurveTableSize, 1, 3);
+        float *values = samples.pixels_asfloat();
+        if (!stages.empty() && stages.back().curve) {
+            std::copy(stages.back().table.begin(), stages.back().table.end(), values);
+        }
+        else {
+            for (uint32_t i = 0; i < CurveTableSize; ++i)
+                std::fill_n(values + i * 3, 3, CurveSample(i));
+            stages.push_back(AlgebraicStage());
+            stages.back().curve = true;
+        }
+
+        op->Apply(samples);
+
+        const float *pix = samples.pixels_asfloat();
+        stages.back().table.assign(pix, pix + CurveTableSize * 3);
+    }
+
+    bool curves = std::any_of(stages.begin(), stages.end(), [](const AlgebraicStage &s) { return s.curve; });
+    float error = curves ? FoldError(stages, operators) : 0.f;
+    if (error > CurveTolerance) {
+        qInfo() << "Compile pipeline : curves not folded, error" << error << "\n";
+        for (auto op : operators)
+            AddOperatorPass(op);
+        return;
+    }
+
+    auto shared = std::make_shared<const std::vector<AlgebraicStage>>(std::move(stages));
+    m_passes.push_back({ [shared, operators](Image &img) { ApplyStages(*shared, operators, img); },
+                         0, uint8_t(operators.size()),
+                         "Algebraic (" + std::to_string(shared->size()) + " stages)" });
+}
+
+void CompiledPipeline::FoldOCIO(const std::vector<ImageOperator *> &operators)
+{
+    if (operators.empty())
+        return;
+
+    if (operators.size() > 1) {
+        try {
+            OCIO::GroupTransformRcPtr group = OCIO::GroupTransform::Create();
+            OCIO::ConstConfigRcPtr config;
+            for (auto op : operators) {
+                auto ocio = static_cast<OCIOOperator *>(op);
+                group->push_back(ocio->OpTransform());
+                if (!config || ocio->OpNeedsConfig())
+                    config = ocio->Config();
+            }
+
+            OCIO::ConstProcessorRcPtr processor = config->getProcessor(group);
+            m_passes.push_back({ [processor](Image &img) { OCIOOperator::ApplyProcessor(processor, img); },
+                                 0, uint8_t(operators.size()), "OCIO Group" });
+            return;
+        } catch (OCIO::Exception &exception) {
+            qWarning() << "OpenColorIO Group Error: " << exception.what() << "\n";
+        }
+    }
+
+    // Single operator, or the group could not be built
+    for (auto op : operators)
+        AddOperatorPass(op);
+}
+
+void CompiledPipeline::AddOperatorPass(ImageOperator *op)
+{
+    m_passes.push_back({ [op](Image &img) { op->Apply(img); },
+                         op->OpNeighbourhood(), 1, op->OpLabel() });
+}
+
+void CompiledPipeline::Apply(Image &img, const std::string &context) const
+{
+    for (auto & pass : m_passes) {
+        TraceScope trace("operator", context + " " + pass.label);
+        pass.apply(img);
+    }
+}
+
+bool CompiledPipeline::Empty() const
+{
+    return m_passes.empty();
+}
+
+uint8_t CompiledPipeline::PassCount() const
+{
+    return m_passes.size();
+}
+
+uint32_t CompiledPipeline::Neighbourhood() const
+{
+    uint32_t n = 0;
+    for (auto & pass : m_passes)
+        n += pass.neighbourhood;
+    return n;
+}
+
+uint8_t CompiledPipeline::OperatorCount() const
+{
+    uint8_t n = 0;
+    for (auto & pass : m_passes)
+        n += pass.operators;
+    return n;
+}
+
+uint8_t CompiledPipeline::Eliminated() const
+{
+    return OperatorCount() - PassCount();
+}
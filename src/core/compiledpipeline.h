@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <utils/generic.h>
+
+
+class Image;
+class ImageOperator;
+
+// Execution plan of an operator chain. Operators are grouped in passes, a
+// pass traversing the image once. Identity operators are dropped, runs of
+// matrices and per-channel curves are folded algebraically (matrices are
+// multiplied, curves composed in a single table) and other runs of adjacent
+// OpenColorIO operators are folded into a single processor.
+//
+// The plan references the operators, it must be compiled again whenever
+// the chain or an operator parameter changes.
+class CompiledPipeline
+{
+  public:
+    struct Pass
+    {
+        FuncT<void(Image &img)> apply;
+        uint32_t neighbourhood = 0;
+        uint8_t operators = 1;
+        std::string label;
+    };
+
+  public:
+    void Compile(const UPtrV<ImageOperator> &operators);
+    // Passes are traced in the "operator" category as "<context> <label>",
+    // the context telling apart pipelines and computations
+    void Apply(Image &img, const std::string &context) const;
+
+    bool Empty() const;
+    uint8_t PassCount() const;
+    uint32_t Neighbourhood() const;
+
+    // Operators applied by the plan and full image traversals saved by
+    // folding
+    uint8_t OperatorCount() const;
+    uint8_t Eliminated() const;
+
+  public:
+    // Samples of the 1D tables curves are composed into : CurveSize linear
+    // samples over [0, 1], then CurveLogSize samples evenly spaced in stops
+    // up to 2^CurveStops for scene-linear values
+    static constexpr uint32_t CurveSize = 8192;
+    static constexpr uint32_t CurveLogSize = 4096;
+    static constexpr uint32_t CurveStops = 16;
+    // Largest error of folded curves against the exact operators, checked
+    // between samples when folding (relative above 1)
+    static constexpr float CurveTolerance = 1e-3f;
+
+  private:
+    void FoldRun(const std::vector<ImageOperator *> &operators);
+    void FoldAlgebraic(const std::vector<ImageOperator *> &operators);
+    void FoldOCIO(const std::vector<ImageOperator *> &operators);
+    void AddOperatorPass(ImageOperator *op);
+
+  private:
+    std::vector<Pass> m_passes;
+};
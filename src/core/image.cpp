@@ -1,11 +1,19 @@
 #include "image.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include <QtCore/QDebug>
 
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
+#include <OpenImageIO/imagecache.h>
 #include <OpenImageIO/filesystem.h>
 
+#include <utils/hash.h>
+#include <utils/parallel.h>
+#include <utils/trace.h>
 #include <utils/pystring.h>
 
 using namespace OIIO;
@@ -49,6 +57,56 @@ TypeDesc PixelTypeToTypeDesc(PixelType type)
     }
 }
 
+static PixelFormat s_workingFormat = PixelFormat::RGBA;
+static uint32_t s_memoryLimit = 4096;
+
+// Working layout : gray, RGB and RGBA images are converted to the working
+// format, any other layout is kept as is.
+ImageSpec WorkingSpec(const ImageSpec &spec)
+{
+    ImageSpec res = spec;
+    res.set_format(TypeDesc::FLOAT);
+
+    int c = spec.nchannels;
+    if (c != 1 && c != 3 && c != 4)
+        return res;
+
+    if (s_workingFormat == PixelFormat::RGB) {
+        res.nchannels = 3;
+        res.channelnames = { "R", "G", "B" };
+        res.alpha_channel = -1;
+    }
+    else {
+        res.nchannels = 4;
+        res.channelnames = { "R", "G", "B", "A" };
+        res.alpha_channel = 3;
+    }
+
+    // Keep source names of color channels
+    if (c >= 3 && spec.channelnames.size() >= 3)
+        std::copy_n(spec.channelnames.begin(), 3, res.channelnames.begin());
+
+    return res;
+}
+
+// Completes pixels decoded with the working layout stride, only the first
+// min(src, dst) channels have been filled.
+void ExpandChannels(float *pixels, uint64_t count, int src, int dst)
+{
+    if (src == 1 && dst >= 3) {
+        for (uint64_t i = 0; i < count; ++i, pixels += dst) {
+            pixels[1] = pixels[0];
+            pixels[2] = pixels[0];
+            if (dst == 4)
+                pixels[3] = 1.f;
+        }
+    }
+    else if (src == 3 && dst == 4) {
+        for (uint64_t i = 0; i < count; ++i, pixels += dst)
+            pixels[3] = 1.f;
+    }
+}
+
 // ----------------------------------------------------------------------------
 
 Image::Image()
@@ -60,24 +118,39 @@ Image::Image()
 Image::Image(const Image &src)
 : m_imgBuf(std::make_unique<ImageBuf>())
 {
-    m_imgBuf->copy(*src.m_imgBuf);
+    *this = src;
 }
 
 Image::Image(Image &&src)
-: m_imgBuf(std::move(src.m_imgBuf))
+: m_imgBuf(std::move(src.m_imgBuf)), m_hash(src.m_hash.load())
 {
 
 }
 
 Image& Image::operator=(const Image &src)
 {
-    m_imgBuf->copy(*src.m_imgBuf);
+    if (this == &src)
+        return *this;
+
+    // Out-of-core images share the image cache, pixels are never copied
+    if (src.cached()) {
+        m_imgBuf.reset(new ImageBuf(src.m_imgBuf->name(), 0, 0, ImageCache::create(true)));
+        m_imgBuf->read(0, 0, false);
+    }
+    else {
+        if (cached())
+            m_imgBuf.reset(new ImageBuf());
+        m_imgBuf->copy(*src.m_imgBuf);
+    }
+
+    m_hash = src.m_hash.load();
     return *this;
 }
 
 Image& Image::operator=(Image &&src)
 {
     m_imgBuf = std::move(src.m_imgBuf);
+    m_hash = src.m_hash.load();
     return *this;
 }
 
@@ -86,12 +159,12 @@ Image::~Image()
 
 }
 
-uint16_t Image::width() const
+uint32_t Image::width() const
 {
     return m_imgBuf->spec().width;
 }
 
-uint16_t Image::height() const
+uint32_t Image::height() const
 {
     return m_imgBuf->spec().height;
 }
@@ -122,7 +195,59 @@ PixelFormat Image::format() const
 
 uint64_t Image::count() const
 {
-    return width() * height();
+    return uint64_t(width()) * height();
+}
+
+bool Image::cached() const
+{
+    return m_imgBuf->storage() == ImageBuf::IMAGECACHE;
+}
+
+uint64_t Image::bytes() const
+{
+    return m_imgBuf->spec().image_bytes();
+}
+
+// Stores a computed hash, zero marks a hash not computed yet
+uint64_t Memoize(std::atomic<uint64_t> &memo, uint64_t hash)
+{
+    hash = hash ? hash : 1;
+    memo.store(hash, std::memory_order_relaxed);
+    return hash;
+}
+
+uint64_t Image::hash() const
+{
+    // Concurrent calls on a shared image may both compute the hash, they
+    // store the same value
+    uint64_t memo = m_hash.load(std::memory_order_relaxed);
+    if (memo)
+        return memo;
+
+    const ImageSpec &spec = m_imgBuf->spec();
+    uint64_t layout[4] = { uint64_t(spec.width), uint64_t(spec.height),
+                           uint64_t(spec.nchannels), uint64_t(spec.format.basetype) };
+    uint64_t seed = XXH64(layout, sizeof(layout));
+
+    if (cached()) {
+        std::string name = m_imgBuf->name();
+        return Memoize(m_hash, XXH64(name.data(), name.size(), seed));
+    }
+
+    const uint8_t *data = pixels();
+    uint64_t size = data ? bytes() : 0;
+
+    // Fixed size stripes hashed concurrently, the result does not depend on
+    // the number of threads
+    const uint64_t stripe = 1 << 20;
+    uint64_t count = (size + stripe - 1) / stripe;
+    std::vector<uint64_t> stripes(count);
+    ParallelFor(0, count, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i)
+            stripes[i] = XXH64(data + i * stripe, std::min(stripe, size - i * stripe));
+    });
+
+    return Memoize(m_hash, XXH64(stripes.data(), count * sizeof(uint64_t), seed));
 }
 
 uint8_t const *Image::pixels() const
@@ -132,11 +257,13 @@ uint8_t const *Image::pixels() const
 
 uint8_t *Image::pixels()
 {
+    m_hash = 0;
     return static_cast<uint8_t*>(m_imgBuf->localpixels());
 }
 
 float *Image::pixels_asfloat()
 {
+    m_hash = 0;
     return static_cast<float*>(m_imgBuf->localpixels());
 }
 
@@ -152,7 +279,42 @@ Image Image::to_type(PixelType t) const
     return res;
 }
 
-Image Image::resize(uint16_t w, uint16_t h, bool keepAspectRatio, const std::string &filter) const
+Image Image::to_format(PixelFormat f) const
+{
+    int c = channels();
+    if (format() == f || format() == PixelFormat::Unknown || f == PixelFormat::Unknown)
+        return *this;
+
+    Image res;
+    if (f == PixelFormat::GRAY) {
+        int channelorder[] = { 0 };
+        ImageBufAlgo::channels(*res.m_imgBuf, *m_imgBuf, 1, channelorder);
+    }
+    else if (f == PixelFormat::RGB) {
+        int channelorder[] = { 0, c == 1 ? 0 : 1, c == 1 ? 0 : 2 };
+        std::string channelnames[] = { "R", "G", "B" };
+        ImageBufAlgo::channels(*res.m_imgBuf, *m_imgBuf, 3, channelorder, {}, channelnames);
+    }
+    else {
+        int channelorder[] = { 0, c == 1 ? 0 : 1, c == 1 ? 0 : 2, c == 4 ? 3 : -1 /*use a float value*/ };
+        float channelvalues[] = { 0 /*ignore*/, 0 /*ignore*/, 0 /*ignore*/, 1.0 };
+        std::string channelnames[] = { "R", "G", "B", "A" };
+        ImageBufAlgo::channels(*res.m_imgBuf, *m_imgBuf, 4, channelorder, channelvalues, channelnames);
+    }
+
+    return res;
+}
+
+Image Image::to_working() const
+{
+    Image res = type() == PixelType::Float ? *this : to_type(PixelType::Float);
+    if (res.format() != s_workingFormat)
+        res = res.to_format(s_workingFormat);
+
+    return res;
+}
+
+Image Image::resize(uint32_t w, uint32_t h, bool keepAspectRatio, const std::string &filter) const
 {
     ImageSpec spec = m_imgBuf->spec();
     spec.width = w;
@@ -166,39 +328,78 @@ Image Image::resize(uint16_t w, uint16_t h, bool keepAspectRatio, const std::str
     else
         ImageBufAlgo::resize(*res.m_imgBuf, *m_imgBuf, filter, 0.0f);
 
+    if (cached())
+        return res.to_working();
+
     return res;
 }
 
-bool Image::read(const std::string &path)
+Image Image::crop(uint32_t x, uint32_t y, uint32_t w, uint32_t h) const
 {
+    Image res;
+    ImageBufAlgo::cut(*res.m_imgBuf, *m_imgBuf, ROI(x, x + w, y, y + h));
+
+    if (cached())
+        return res.to_working();
+
+    return res;
+}
+
+void Image::paste(const Image &img, uint32_t x, uint32_t y)
+{
+    m_hash = 0;
+    ImageBufAlgo::paste(*m_imgBuf, x, y, 0, 0, *img.m_imgBuf);
+}
+
+bool Image::read(const std::string &path, uint32_t targetWidth, uint32_t targetHeight)
+{
+    m_hash = 0;
+
     if (path.empty())
         return false;
 
-    m_imgBuf.reset(new ImageBuf(path));
+    TraceScope trace("io", "Read " + Filesystem::filename(path));
+
+    if (targetWidth != 0 && targetHeight != 0)
+        return read_reduced(path, targetWidth, targetHeight);
 
-    if (!m_imgBuf->read(0, 0, true, TypeDesc::FLOAT)) {
+    auto in = ImageInput::open(path);
+    if (!in) {
         qWarning() << "Could not open image !";
         return false;
     }
 
-    const ImageSpec &spec = m_imgBuf->nativespec();
-    Image::PrintMetadata(path, spec);
+    Image::PrintMetadata(path, in->spec());
 
-    to_rgba_format();
+    if (WorkingSpec(in->spec()).image_bytes() > (uint64_t(s_memoryLimit) << 20)) {
+        in->close();
+        return read_cached(path);
+    }
 
-    return true;
+    return decode(*in, 0);
 }
 
 bool Image::write(const std::string &path, PixelType type) const
 {
+    TraceScope trace("io", "Write " + Filesystem::filename(path));
+
     m_imgBuf->set_write_format(PixelTypeToTypeDesc(type));
     return m_imgBuf->write(path);
 }
 
-Image Image::FromFile(const std::string &path)
+Image Image::Allocate(uint32_t w, uint32_t h, uint8_t channels, PixelType type)
+{
+    ImageSpec spec(w, h, channels, PixelTypeToTypeDesc(type));
+
+    Image res;
+    res.m_imgBuf.reset(new ImageBuf(spec));
+    return res;
+}
+
+Image Image::FromFile(const std::string &path, uint32_t targetWidth, uint32_t targetHeight)
 {
     Image res;
-    if (!res.read(path))
+    if (!res.read(path, targetWidth, targetHeight))
         return Image();
 
     return res;
@@ -217,20 +418,20 @@ Image Image::FromBuffer(void * buffer, size_t size)
         return Image();
     }
 
-    ImageSpec spec = in->spec();
-    spec.set_format(TypeDesc::FLOAT);
-    Image::PrintMetadata("Embeded", spec);
+    Image::PrintMetadata("Embeded", in->spec());
 
     Image res;
-    res.m_imgBuf.reset(new ImageBuf(spec));
-    in->read_image(
-        TypeDesc::FLOAT,
-        res.m_imgBuf->localpixels(),
-        res.m_imgBuf->pixel_stride(),
-        res.m_imgBuf->scanline_stride(),
-        res.m_imgBuf->z_stride());
+    if (!res.decode(*in, 0))
+        return Image();
+
+    return res;
+}
 
-    res.to_rgba_format();
+Image Image::FromScanlines(ImageInput &in, uint32_t ybegin, uint32_t yend)
+{
+    Image res;
+    if (!res.decode(in, 0, ybegin, yend))
+        return Image();
 
     return res;
 }
@@ -312,6 +513,37 @@ Image Image::Lattice(uint16_t size, uint16_t maxwidth, LUTOrder order)
     return res;
 }
 
+void Image::SetWorkingFormat(PixelFormat f)
+{
+    if (f != PixelFormat::RGB && f != PixelFormat::RGBA) {
+        qWarning() << "Working format must be RGB or RGBA !";
+        return;
+    }
+
+    s_workingFormat = f;
+}
+
+PixelFormat Image::WorkingFormat()
+{
+    return s_workingFormat;
+}
+
+void Image::SetMemoryLimit(uint32_t megabytes)
+{
+    s_memoryLimit = megabytes;
+
+    // Scanline files are accessed by tiles too, so only the regions
+    // actually needed are kept in memory
+    ImageCache *cache = ImageCache::create(true);
+    cache->attribute("max_memory_MB", float(megabytes));
+    cache->attribute("autotile", 256);
+}
+
+uint32_t Image::MemoryLimit()
+{
+    return s_memoryLimit;
+}
+
 void Image::PrintMetadata(const std::string &filepath, const ImageSpec &spec)
 {
     qInfo() << "File -" << QString::fromStdString(filepath);
@@ -409,18 +641,142 @@ Image Image::operator /(const Image & rhs)
     return res;
 }
 
-void Image::to_rgba_format()
+bool Image::read_reduced(const std::string &path, uint32_t targetWidth, uint32_t targetHeight)
 {
-    if (channels() == 1) {
-        int channelorder[] = { 0, 0, 0, -1 /*use a float value*/ };
-        float channelvalues[] = { 0 /*ignore*/, 0 /*ignore*/, 0 /*ignore*/, 1.0 };
-        std::string channelnames[] = { "R", "G", "B", "A" };
-        ImageBufAlgo::channels(*m_imgBuf, *m_imgBuf, 4, channelorder, channelvalues, channelnames);
+    auto in = ImageInput::open(path);
+    if (!in) {
+        qWarning() << "Could not open image !";
+        return false;
     }
-    else if (channels() == 3) {
-        int channelorder[] = { 0, 1, 2, -1 /*use a float value*/ };
-        float channelvalues[] = { 0 /*ignore*/, 0 /*ignore*/, 0 /*ignore*/, 1.0 };
-        std::string channelnames[] = { "", "", "", "A" };
-        ImageBufAlgo::channels(*m_imgBuf, *m_imgBuf, 4, channelorder, channelvalues, channelnames);
+
+    // Use the smallest MIP level still larger than the target (mipmapped
+    // EXR and TIFF files)
+    int miplevel = 0;
+    for (int m = 1; in->seek_subimage(0, m); ++m) {
+        const ImageSpec &spec = in->spec();
+        if (uint32_t(spec.width) < targetWidth || uint32_t(spec.height) < targetHeight)
+            break;
+        miplevel = m;
     }
-}
\ No newline at end of file
+
+    if (!in->seek_subimage(0, miplevel)) {
+        qWarning() << "Could not open image !";
+        return false;
+    }
+
+    // Camera raw files can be demosaiced at half resolution directly
+    ImageSpec spec = in->spec();
+    if (miplevel == 0 && std::string(in->format_name()) == "raw"
+        && uint32_t(spec.width) >= 2 * targetWidth
+        && uint32_t(spec.height) >= 2 * targetHeight) {
+        ImageSpec config;
+        config.attribute("raw:HalfSize", 1);
+        in = ImageInput::open(path, &config);
+        if (!in) {
+            qWarning() << "Could not open image !";
+            return false;
+        }
+        spec = in->spec();
+    }
+
+    Image::PrintMetadata(path, spec);
+
+    // Remaining reduction is a box decimation by an integer factor, done
+    // strip by strip while reading
+    uint32_t factor = std::max(1u, std::min(spec.width / targetWidth, spec.height / targetHeight));
+    if (factor == 1)
+        return decode(*in, miplevel);
+
+    uint32_t w = spec.width / factor;
+    uint32_t h = spec.height / factor;
+
+    ImageSpec outSpec = WorkingSpec(spec);
+    outSpec.x = outSpec.y = 0;
+    outSpec.width = outSpec.full_width = w;
+    outSpec.height = outSpec.full_height = h;
+    m_imgBuf.reset(new ImageBuf(outSpec, InitializePixels::No));
+    m_hash = 0;
+
+    int oc = outSpec.nchannels;
+    int c = std::min<int>(spec.nchannels, oc);
+    std::vector<float> strip(size_t(spec.width) * c * factor);
+    float *out = static_cast<float *>(m_imgBuf->localpixels());
+    float norm = 1.f / (factor * factor);
+
+    for (uint32_t y = 0; y < h; ++y) {
+        int ybegin = spec.y + y * factor;
+        if (!in->read_scanlines(0, miplevel, ybegin, ybegin + factor, 0, 0, c,
+                                TypeDesc::FLOAT, strip.data())) {
+            qWarning() << "Could not read image !" << QString::fromStdString(in->geterror());
+            return false;
+        }
+
+        float *o = out + size_t(y) * w * oc;
+        for (uint32_t x = 0; x < w; ++x)
+            for (int i = 0; i < c; ++i) {
+                float sum = 0.f;
+                for (uint32_t r = 0; r < factor; ++r) {
+                    const float *row = strip.data() + (size_t(r) * spec.width + x * factor) * c;
+                    for (uint32_t k = 0; k < factor; ++k)
+                        sum += row[k * c + i];
+                }
+                o[x * oc + i] = sum * norm;
+            }
+
+        ExpandChannels(o, w, spec.nchannels, oc);
+    }
+
+    return true;
+}
+
+bool Image::read_cached(const std::string &path)
+{
+    qInfo() << "Image exceeds memory limit (" << s_memoryLimit << "MB ), using tiled access";
+
+    m_imgBuf.reset(new ImageBuf(path, 0, 0, ImageCache::create(true)));
+    if (!m_imgBuf->read(0, 0, false)) {
+        qWarning() << "Could not open image !" << QString::fromStdString(m_imgBuf->geterror());
+        return false;
+    }
+
+    return true;
+}
+
+bool Image::decode(ImageInput &in, int miplevel)
+{
+    return decode(in, miplevel, 0, in.spec().height);
+}
+
+bool Image::decode(ImageInput &in, int miplevel, int ybegin, int yend)
+{
+    const ImageSpec &spec = in.spec();
+
+    // Decode straight into the working layout, no intermediate buffer
+    ImageSpec outSpec = WorkingSpec(spec);
+    if (ybegin != 0 || yend != spec.height) {
+        outSpec.y = 0;
+        outSpec.height = yend - ybegin;
+    }
+    m_imgBuf.reset(new ImageBuf(outSpec, InitializePixels::No));
+
+    int c = std::min<int>(spec.nchannels, outSpec.nchannels);
+    stride_t xstride = outSpec.nchannels * sizeof(float);
+    stride_t ystride = xstride * spec.width;
+    int rows = spec.tile_height > 0 ? spec.tile_height : 64;
+    uint8_t *out = static_cast<uint8_t *>(m_imgBuf->localpixels());
+
+    for (int y = ybegin; y < yend; y += rows) {
+        int ylast = std::min(y + rows, yend);
+        float *o = reinterpret_cast<float *>(out + (y - ybegin) * ystride);
+
+        if (!in.read_scanlines(0, miplevel, spec.y + y, spec.y + ylast, 0, 0, c,
+                               TypeDesc::FLOAT, o, xstride, ystride)) {
+            qWarning() << "Could not read image !" << QString::fromStdString(in.geterror());
+            return false;
+        }
+
+        ExpandChannels(o, uint64_t(ylast - y) * spec.width, spec.nchannels, outSpec.nchannels);
+    }
+
+    return true;
+}
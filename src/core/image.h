@@ -2,6 +2,8 @@
 
 #include "utils/generic.h"
 
+#include <atomic>
+
 #include <OpenImageIO/oiioversion.h>
 
 
@@ -37,7 +39,7 @@ enum class LUTOrder
     RED_FAST,
 };
 
-namespace OIIO_NAMESPACE { class ImageBuf; class ImageSpec; }
+namespace OIIO_NAMESPACE { class ImageBuf; class ImageInput; class ImageOutput; class ImageSpec; }
 
 class Image
 {
@@ -50,13 +52,25 @@ class Image
     ~Image();
 
   public:
-    uint16_t width() const;
-    uint16_t height() const;
+    uint32_t width() const;
+    uint32_t height() const;
     uint8_t channels() const;
     PixelType type() const;
     PixelFormat format() const;
 
     uint64_t count() const;
+    uint64_t bytes() const;
+
+    // Content identity, from the image layout and pixel values (file name
+    // for out-of-core images). The hash is computed in parallel and kept
+    // until pixels are accessed for writing, pixels must not be written
+    // through a pointer obtained before hashing. Concurrent calls on a
+    // shared const image are safe.
+    uint64_t hash() const;
+
+    // Out-of-core image, pixels are accessed through the image cache and
+    // pixels() is null. Crops and resizes are in memory, in working format.
+    bool cached() const;
 
     uint8_t const *pixels() const;
     uint8_t *pixels();
@@ -66,18 +80,38 @@ class Image
 
   public:
     Image to_type(PixelType type) const;
+    Image to_format(PixelFormat format) const;
+    Image to_working() const;
 
-    Image resize(uint16_t w, uint16_t h, bool keepAspectRatio = true, const std::string &filter = "") const;
+    Image resize(uint32_t w, uint32_t h, bool keepAspectRatio = true, const std::string &filter = "") const;
+    Image crop(uint32_t x, uint32_t y, uint32_t w, uint32_t h) const;
+    void paste(const Image &img, uint32_t x, uint32_t y);
 
-    bool read(const std::string &path);
+    // When a target size is given, the image is decoded at the smallest
+    // resolution still larger than the target (at most twice as large on
+    // one dimension), instead of the full resolution.
+    bool read(const std::string &path, uint32_t targetWidth = 0, uint32_t targetHeight = 0);
     bool write(const std::string &path, PixelType type = PixelType::Uint16) const;
 
   public:
-    static Image FromFile(const std::string &path);
+    static Image Allocate(uint32_t w, uint32_t h, uint8_t channels, PixelType type = PixelType::Float);
+    static Image FromFile(const std::string &path, uint32_t targetWidth = 0, uint32_t targetHeight = 0);
     static Image FromBuffer(void *buffer, size_t size);
+    // Rows [ybegin, yend) of an opened image, in working format
+    static Image FromScanlines(OIIO::ImageInput &in, uint32_t ybegin, uint32_t yend);
     static Image Ramp1D(uint16_t size, float min = 0.f, float max = 1.f, RampType t = RampType::NEUTRAL);
     static Image Lattice(uint16_t size, uint16_t maxwidth = 512, LUTOrder = LUTOrder::RED_FAST);
 
+    // Layout images are loaded into (RGB or RGBA), applies to images loaded
+    // afterwards.
+    static void SetWorkingFormat(PixelFormat format);
+    static PixelFormat WorkingFormat();
+
+    // Images larger than this limit (in working format) are read through
+    // the image cache, which is capped to the same amount.
+    static void SetMemoryLimit(uint32_t megabytes);
+    static uint32_t MemoryLimit();
+
     static void PrintMetadata(const std::string &filepath, const OIIO::ImageSpec &spec);
     static std::vector<std::string> SupportedExtensions();
 
@@ -91,8 +125,13 @@ class Image
     Image operator/(const Image &rhs);
 
   private:
-    void to_rgba_format();
+    bool read_reduced(const std::string &path, uint32_t targetWidth, uint32_t targetHeight);
+    bool read_cached(const std::string &path);
+    bool decode(OIIO::ImageInput &in, int miplevel);
+    bool decode(OIIO::ImageInput &in, int miplevel, int ybegin, int yend);
 
   private:
     UPtr<OIIO::ImageBuf> m_imgBuf;
+    // Memoized hash(), 0 until computed
+    mutable std::atomic<uint64_t> m_hash { 0 };
 };
\ No newline at end of file
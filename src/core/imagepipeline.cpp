@@ -1,16 +1,37 @@
 #include "imagepipeline.h"
 
+#include <algorithm>
 #include <iterator>
-#include <fstream>
-#include <iomanip>
 
 #include <QtCore/QDebug>
+#include <QtCore/QTimer>
 
 #include <utils/generic.h>
 #include <utils/chrono.h>
+#include <utils/trace.h>
+
+#include <operator/lut/frozen.h>
+
+#include "imagestream.h"
+#include "lutio.h"
 
 
 ImagePipeline::ImagePipeline()
+{
+    // Completes the evaluation of a region of interest, on next event loop
+    // iteration so the region can be displayed first.
+    m_fullTimer = std::make_unique<QTimer>();
+    m_fullTimer->setSingleShot(true);
+    m_fullTimer->setInterval(0);
+    QObject::connect(m_fullTimer.get(), &QTimer::timeout, [this]() { ComputeFull(); });
+
+    m_refineTimer = std::make_unique<QTimer>();
+    m_refineTimer->setSingleShot(true);
+    m_refineTimer->setInterval(300);
+    QObject::connect(m_refineTimer.get(), &QTimer::timeout, [this]() { Refine(); });
+}
+
+ImagePipeline::~ImagePipeline()
 {
 
 }
@@ -22,8 +43,27 @@ void ImagePipeline::SetInput(const Image & img)
 
     m_inputImg = img;
     m_outputImg = img;
+    m_roi.reset();
+    m_inputPyramid.reset(m_inputImg);
+
+    // Out-of-core inputs are graded at the largest pyramid level leaving
+    // room for processing within the memory limit
+    m_workingLevel = 0;
+    if (m_inputImg.cached()) {
+        uint64_t limit = uint64_t(Image::MemoryLimit()) << 20;
+        uint64_t pixelSize = sizeof(float) * (Image::WorkingFormat() == PixelFormat::RGB ? 3 : 4);
+        auto levelBytes = [&](uint8_t l) {
+            return pixelSize * ImagePyramid::LevelSize(m_inputImg.width(), l)
+                             * ImagePyramid::LevelSize(m_inputImg.height(), l);
+        };
+
+        while (m_workingLevel + 1 < m_inputPyramid.levels() && 2 * levelBytes(m_workingLevel) > limit)
+            ++m_workingLevel;
+
+        qInfo() << "Out-of-core input, working level" << m_workingLevel;
+    }
 
-    EmitEvent<Evt::NewInput>(m_inputImg);
+    EmitEvent<Evt::NewInput>(DisplayInput());
 
     Compute();
 }
@@ -33,6 +73,11 @@ Image & ImagePipeline::GetInput()
     return m_inputImg;
 }
 
+ImagePyramid & ImagePipeline::GetInputPyramid()
+{
+    return m_inputPyramid;
+}
+
 Image & ImagePipeline::GetOutput()
 {
     return m_outputImg;
@@ -43,6 +88,33 @@ void ImagePipeline::SetName(const std::string &name)
     m_name = name;
 }
 
+void ImagePipeline::SetRegionOfInterest(const RectU &roi, uint32_t targetWidth, uint32_t targetHeight)
+{
+    m_roi = roi;
+    m_roiTargetWidth = targetWidth;
+    m_roiTargetHeight = targetHeight;
+}
+
+void ImagePipeline::ResetRegionOfInterest()
+{
+    m_roi.reset();
+}
+
+void ImagePipeline::SetProgressive(bool enabled)
+{
+    m_progressive = enabled;
+}
+
+void ImagePipeline::SetRefineInterval(int msec)
+{
+    m_refineTimer->setInterval(msec);
+}
+
+void ImagePipeline::SetResultCache(ResultCache *cache)
+{
+    m_resultCache = cache;
+}
+
 uint8_t ImagePipeline::OperatorCount() const
 {
     return m_operators.size();
@@ -62,9 +134,9 @@ ImageOperator* ImagePipeline::AddOperator(ImageOperator * op, int8_t index)
     }
 
     UPtr<ImageOperator> & optr = *m_operators.emplace(pos, UPtr<ImageOperator>(op));
-    optr->Subscribe<ImageOperator::Update>(std::bind(&ImagePipeline::Compute, this) );
+    ConnectOperator(optr.get());
 
-    Compute();
+    OperatorUpdated();
 
     return optr.get();
 }
@@ -76,8 +148,10 @@ ImageOperator* ImagePipeline::ReplaceOperator(ImageOperator * op, int8_t index)
         return nullptr;
     }
 
+    m_connections.erase(m_operators[index].get());
     m_operators[index] = UPtr<ImageOperator>(op);
-    m_operators[index]->Subscribe<ImageOperator::Update>(std::bind(&ImagePipeline::Compute, this) );
+    ConnectOperator(op);
+    m_compiledDirty = true;
 
     return m_operators[index].get();
 }
@@ -98,8 +172,48 @@ bool ImagePipeline::DeleteOperator(uint8_t index)
         return false;
     }
 
+    m_connections.erase(m_operators[index].get());
     m_operators.erase(m_operators.begin() + index);
-    Compute();
+    OperatorUpdated();
+
+    return true;
+}
+
+ImageOperator *ImagePipeline::FreezeOperators(uint8_t first, uint8_t last)
+{
+    if (first > last || last >= m_operators.size()) {
+        qWarning() << "Cannot freeze operators" << int(first) << "to" << int(last);
+        return nullptr;
+    }
+
+    UPtrV<ImageOperator> operators;
+    for (uint8_t i = first; i <= last; ++i)
+        operators.push_back(TakeOperator(first));
+
+    FrozenOperator *frozen = new FrozenOperator();
+    frozen->Freeze(std::move(operators));
+
+    return AddOperator(frozen, first);
+}
+
+bool ImagePipeline::UnfreezeOperator(uint8_t index)
+{
+    if (index >= m_operators.size())
+        return false;
+
+    auto frozen = dynamic_cast<FrozenOperator *>(m_operators[index].get());
+    if (!frozen)
+        return false;
+
+    UPtrV<ImageOperator> operators = frozen->Unfreeze();
+    TakeOperator(index);
+
+    for (auto & op : operators) {
+        ConnectOperator(op.get());
+        m_operators.insert(m_operators.begin() + index++, std::move(op));
+    }
+
+    OperatorUpdated();
 
     return true;
 }
@@ -107,65 +221,339 @@ bool ImagePipeline::DeleteOperator(uint8_t index)
 void ImagePipeline::Reset()
 {
     m_operators.clear();
+    m_connections.clear();
 
-    Compute();
+    OperatorUpdated();
 }
 
 void ImagePipeline::Init()
 {
-    EmitEvent<Evt::NewInput>(m_inputImg);
-    EmitEvent<Evt::Update>(m_outputImg);
+    EmitEvent<Evt::NewInput>(DisplayInput());
+    EmitEvent<Evt::Update>(m_outputImg, m_outputQuality);
+}
+
+void ImagePipeline::BeginUpdate()
+{
+    ++m_updateDepth;
+}
+
+void ImagePipeline::EndUpdate()
+{
+    if (m_updateDepth == 0)
+        return;
+
+    if (--m_updateDepth == 0 && m_updatePending) {
+        m_updatePending = false;
+        Compute();
+    }
 }
 
 void ImagePipeline::Compute()
 {
-    Chrono c;
-    c.start();
+    if (m_updateDepth > 0) {
+        m_updatePending = true;
+        return;
+    }
 
     if (!m_inputImg)
         return;
 
-    m_outputImg = m_inputImg;
-    ComputeImage(m_outputImg);
+    if (m_progressive && ComputeProxy()) {
+        m_refineTimer->start();
+        return;
+    }
+
+    Refine();
+}
+
+bool ImagePipeline::ComputeProxy()
+{
+    // Quarter resolution for large images, half resolution otherwise, small
+    // images are not worth a proxy.
+    uint8_t level = m_inputImg.width() > 2048 ? 2 : 1;
+    if (m_inputImg.cached())
+        level = m_workingLevel + 1;
+
+    if (level >= m_inputPyramid.levels()
+        || ImagePyramid::LevelSize(m_inputImg.width(), level) < 256)
+        return false;
+
+    m_fullTimer->stop();
+
+    m_outputImg = m_inputPyramid.level(level);
+    ComputeImage(m_outputImg, "proxy");
+
+    m_outputQuality = Quality::Proxy;
+    EmitEvent<Evt::Update>(m_outputImg, m_outputQuality);
+
+    return true;
+}
+
+bool ImagePipeline::ComputeRegion()
+{
+    // Out-of-core output is not at input resolution, regions cannot be
+    // pasted back
+    if (!m_roi || m_inputImg.cached())
+        return false;
+
+    uint32_t w = m_inputImg.width();
+    uint32_t h = m_inputImg.height();
+    if (m_roi->x >= w || m_roi->y >= h)
+        return false;
+
+    RectU roi = *m_roi;
+    roi.width = std::min(roi.width, w - roi.x);
+    roi.height = std::min(roi.height, h - roi.y);
+    if (roi.width == 0 || roi.height == 0)
+        return false;
+
+    uint32_t tw = std::clamp(m_roiTargetWidth, 1u, roi.width);
+    uint32_t th = std::clamp(m_roiTargetHeight, 1u, roi.height);
+
+    // Not worth it when the region costs about as much as the full image
+    if (2 * uint64_t(tw) * th > m_inputImg.count())
+        return false;
+
+    // Previous output is the graded proxy, upscaled as background so that
+    // pixels outside the region keep the current grade until ComputeFull.
+    // Without any graded output, start from a fresh copy of the input.
+    if (m_outputImg.width() != w || m_outputImg.height() != h) {
+        if (m_outputImg && m_outputQuality == Quality::Proxy)
+            m_outputImg = m_outputImg.resize(w, h, false).to_type(m_inputImg.type());
+        else
+            m_outputImg = m_inputImg;
+    }
+
+    // Evaluate the region at display resolution, starting from the coarsest
+    // pyramid level that still holds enough pixels
+    uint8_t level = ImagePyramid::LevelFor(roi.width, roi.height, tw, th);
+    level = std::min<uint8_t>(level, m_inputPyramid.levels() - 1);
+
+    const Image &src = m_inputPyramid.level(level);
+    uint32_t lx = std::min(roi.x >> level, uint32_t(src.width()) - 1);
+    uint32_t ly = std::min(roi.y >> level, uint32_t(src.height()) - 1);
+    uint32_t lw = std::clamp(roi.width >> level, 1u, uint32_t(src.width()) - lx);
+    uint32_t lh = std::clamp(roi.height >> level, 1u, uint32_t(src.height()) - ly);
+
+    Image region = src.crop(lx, ly, lw, lh);
+    if (tw != lw || th != lh)
+        region = region.resize(tw, th, false, "box");
 
-    EmitEvent<Evt::Update>(m_outputImg);
+    bool scaled = (tw != roi.width || th != roi.height);
+
+    ComputeImage(region, "region");
+
+    if (scaled)
+        region = region.resize(roi.width, roi.height, false);
+
+    m_outputImg.paste(region, roi.x, roi.y);
+
+    m_outputQuality = Quality::Proxy;
+    EmitEvent<Evt::Update>(m_outputImg, m_outputQuality);
+
+    return true;
+}
+
+void ImagePipeline::ComputeFull()
+{
+    m_fullTimer->stop();
+    m_refineTimer->stop();
+
+    // Out-of-core inputs are computed on the working level (see
+    // SetInput), a level 0 working level is read in memory first
+    m_outputImg = DisplayInput();
+    if (m_outputImg.cached())
+        m_outputImg = m_outputImg.crop(0, 0, m_outputImg.width(), m_outputImg.height());
+    ComputeImage(m_outputImg, "full");
+
+    m_outputQuality = Quality::Full;
+    EmitEvent<Evt::Update>(m_outputImg, m_outputQuality);
+}
+
+void ImagePipeline::Refine()
+{
+    m_refineTimer->stop();
+
+    if (ComputeRegion()) {
+        m_fullTimer->start();
+        return;
+    }
+
+    ComputeFull();
 }
 
-void ImagePipeline::ComputeImage(Image & img)
+void ImagePipeline::ComputeImage(Image & img, const std::string &stage)
 {
+    TraceScope trace("pipeline", "Compute " + m_name);
+
     Chrono c;
     c.start();
 
-    for (auto & t : m_operators)
-        if (!t->IsIdentity())
-            t->Apply(img);
+    OptT<ResultCache::Key> key;
+    if (m_resultCache && m_resultCache->budget() > 0) {
+        key = ResultCache::Key { img.hash(), ChainFingerprint(), img.width(), img.height() };
+
+        bool hit = m_resultCache->find(*key, img);
+        qInfo() << "Result cache" << (hit ? "hit" : "miss") << "(" << QString::fromStdString(m_name)
+                << ") : " << fixed << qSetRealNumberPrecision(2) << m_resultCache->hitRate()
+                << "% hit rate," << m_resultCache->bytes() / (1024.f * 1024.f) << "MB used";
+        if (hit)
+            return;
+    }
+
+    ApplyOperators(img, stage);
+
+    if (key)
+        m_resultCache->insert(*key, img);
 
     qInfo() << "Compute (" << QString::fromStdString(m_name)
             << ") Pipeline in : " << fixed << qSetRealNumberPrecision(2)
             << c.ellapsed(Chrono::MILLISECONDS) << "msec.\n";
 }
 
-void ImagePipeline::ExportLUT(const std::string & filename, uint32_t size)
+void ImagePipeline::ConnectOperator(ImageOperator *op)
+{
+    m_connections[op] = op->Subscribe<ImageOperator::Update>(std::bind(&ImagePipeline::OperatorUpdated, this));
+}
+
+UPtr<ImageOperator> ImagePipeline::TakeOperator(uint8_t index)
+{
+    UPtr<ImageOperator> op = std::move(m_operators[index]);
+    m_operators.erase(m_operators.begin() + index);
+
+    auto it = m_connections.find(op.get());
+    if (it != m_connections.end()) {
+        op->Unsubscribe<ImageOperator::Update>(it->second);
+        m_connections.erase(it);
+    }
+
+    m_compiledDirty = true;
+
+    return op;
+}
+
+void ImagePipeline::OperatorUpdated()
+{
+    m_compiledDirty = true;
+
+    Compute();
+}
+
+const CompiledPipeline & ImagePipeline::Compiled()
+{
+    if (m_compiledDirty) {
+        m_compiled.Compile(m_operators);
+        m_compiledDirty = false;
+    }
+
+    return m_compiled;
+}
+
+void ImagePipeline::ApplyOperators(Image & img, const std::string &stage)
+{
+    const CompiledPipeline & compiled = Compiled();
+
+    // Reduced precision storage is converted once for the whole chain
+    // instead of at each operator boundary
+    PixelType storage = img.type();
+    bool convert = storage != PixelType::Float && !compiled.Empty();
+    if (convert)
+        img = img.to_type(PixelType::Float);
+
+    compiled.Apply(img, m_name + "/" + stage);
+
+    if (convert)
+        img = img.to_type(storage);
+}
+
+uint64_t ImagePipeline::ChainFingerprint() const
+{
+    std::string fingerprint;
+    for (auto & t : m_operators)
+        fingerprint += t->Fingerprint() + "\n";
+
+    return std::hash<std::string>{}(fingerprint);
+}
+
+const Image & ImagePipeline::DisplayInput()
+{
+    if (m_workingLevel > 0)
+        return m_inputPyramid.level(m_workingLevel);
+
+    return m_inputImg;
+}
+
+bool ImagePipeline::Render(const std::string &src, const std::string &dst, PixelType type, uint32_t stripeRows)
+{
+    Chrono c;
+    c.start();
+
+    ImageReader reader(src);
+    if (!reader)
+        return false;
+
+    uint32_t w = reader.width();
+    uint32_t h = reader.height();
+
+    // Extra rows read around each stripe, for operators working on a
+    // neighbourhood
+    uint32_t halo = Compiled().Neighbourhood();
+
+    UPtr<ImageWriter> writer;
+    for (uint32_t y = 0; y < h; y += stripeRows) {
+        uint32_t yend = std::min(y + stripeRows, h);
+        uint32_t ybegin = y > halo ? y - halo : 0;
+        uint32_t ylast = std::min(yend + halo, h);
+
+        TraceScope trace("stripe", "Stripe");
+        Image stripe = reader.read(ybegin, ylast);
+        if (!stripe)
+            return false;
+
+        ApplyOperators(stripe, "render");
+
+        // Output layout is only known after the first stripe
+        if (!writer) {
+            writer = std::make_unique<ImageWriter>(dst, w, h, stripe.channels(), type);
+            if (!*writer)
+                return false;
+        }
+
+        if (!writer->write(stripe, y - ybegin, y, yend - y))
+            return false;
+    }
+
+    if (!writer || !writer->close())
+        return false;
+
+    qInfo() << "Render (" << QString::fromStdString(m_name) << ")"
+            << QString::fromStdString(dst) << "in : " << fixed << qSetRealNumberPrecision(2)
+            << c.ellapsed(Chrono::MILLISECONDS) << "msec.\n";
+
+    return true;
+}
+
+LUT3D ImagePipeline::BakeLUT(uint32_t size, LUTShaper shaper)
 {
-    // Lattice image
-    Image lattice = Image::Lattice(size);
+    return LUT3D::Bake([this](Image &img) { ComputeImage(img, "bake"); }, size, shaper);
+}
 
-    // Run pipeline
-    ComputeImage(lattice);
+bool ImagePipeline::ExportLUT(const std::string & filename, uint32_t size)
+{
+    LUT3D lut = BakeLUT(size);
+    if (!lut)
+        return false;
 
-    // Extract lattice image to lut
-    std::ofstream ofs(filename);
-    ofs << "LUT_3D_SIZE " << size << "\n";
-    ofs << "DOMAIN_MIN 0.000000 0.000000 0.000000\n";
-    ofs << "DOMAIN_MAX 1.000000 1.000000 1.000000\n";
-    ofs << "\n";
+    return WriteLUT(lut, filename);
+}
 
-    uint32_t i = 0;
-    float * pix = lattice.pixels_asfloat();
-    for (uint32_t r = 0; r < size; ++r)
-        for (uint32_t g = 0; g < size; ++g)
-            for (uint32_t b = 0; b < size; ++b) {
-                ofs << std::setprecision(6) << std::fixed << pix[i * 3] << " " << pix[i * 3 + 1] << " " << pix[i * 3 + 2] << "\n";
-                i++;
-            }
+PipelineUpdate::PipelineUpdate(ImagePipeline &pipeline)
+: m_pipeline(pipeline)
+{
+    m_pipeline.BeginUpdate();
+}
+
+PipelineUpdate::~PipelineUpdate()
+{
+    m_pipeline.EndUpdate();
 }
@@ -1,15 +1,23 @@
 #pragma once
 
+#include "compiledpipeline.h"
 #include "image.h"
+#include "imagepyramid.h"
+#include "lut.h"
+#include "resultcache.h"
+#include "types.h"
 #include "utils/event_source.h"
 #include "operator/imageoperator.h"
 
+#include <map>
 #include <vector>
 
 
+class QTimer;
+
 typedef EventDesc<
     FuncT<void(const Image &img)>,
-    FuncT<void(const Image &img)>> IPEvtDesc;
+    FuncT<void(const Image &img, Quality quality)>> IPEvtDesc;
 
 class ImagePipeline : public EventSource<IPEvtDesc>
 {
@@ -18,14 +26,36 @@ class ImagePipeline : public EventSource<IPEvtDesc>
 
   public:
     ImagePipeline();
+    ~ImagePipeline();
 
   public:
+    // Out-of-core inputs (see Image::cached) are not previewed at full
+    // resolution : proxy and full quality outputs are computed on a working
+    // level of the input pyramid, the largest one fitting the memory limit
+    // twice. Full resolution output goes through Render.
     void SetInput(const Image &img);
     Image &GetInput();
+    ImagePyramid &GetInputPyramid();
     Image &GetOutput();
 
     void SetName(const std::string &name);
 
+    // Region of the input currently displayed and the resolution it is
+    // displayed at. When set, this region is evaluated first and the rest
+    // of the image is filled in lazily.
+    void SetRegionOfInterest(const RectU &roi, uint32_t targetWidth, uint32_t targetHeight);
+    void ResetRegionOfInterest();
+
+    // In progressive mode, a reduced resolution proxy of the input is
+    // computed first and refined to full resolution once the pipeline has
+    // been idle for the refine interval (in msec).
+    void SetProgressive(bool enabled);
+    void SetRefineInterval(int msec);
+
+    // Results of ComputeImage are looked up in and stored to this cache,
+    // null disables caching
+    void SetResultCache(ResultCache *cache);
+
     uint8_t OperatorCount() const;
     ImageOperator &GetOperator(uint8_t index);
 
@@ -35,29 +65,97 @@ class ImagePipeline : public EventSource<IPEvtDesc>
     int8_t FindOperator(const ImageOperator * op);
     bool DeleteOperator(uint8_t index);
 
+    // Replaces operators [first, last] by a single operator baking them in
+    // a 3D LUT, unfreezing restores the original operators.
+    ImageOperator *FreezeOperators(uint8_t first, uint8_t last);
+    bool UnfreezeOperator(uint8_t index);
+
     void Reset();
 
+    // Computations requested between BeginUpdate and EndUpdate are deferred
+    // and coalesced in a single one when the outermost update ends (see
+    // PipelineUpdate).
+    void BeginUpdate();
+    void EndUpdate();
+
     void Init();
     void Compute();
-    void ComputeImage(Image & img);
-    void ExportLUT(const std::string &filename, uint32_t size);
+    // The stage names the computation in operator trace spans, as
+    // "<pipeline>/<stage> <operator>"
+    void ComputeImage(Image & img, const std::string &stage = "compute");
+    LUT3D BakeLUT(uint32_t size, LUTShaper shaper = LUTShaper::Linear);
+    // Format from the file extension, see LUTFormat
+    bool ExportLUT(const std::string &filename, uint32_t size);
+
+    // Streams an image file through the pipeline into another file by
+    // stripes of rows, memory use is bounded by the stripe size.
+    bool Render(const std::string &src, const std::string &dst,
+                PixelType type = PixelType::Uint16, uint32_t stripeRows = 64);
+
+  private:
+    bool ComputeProxy();
+    bool ComputeRegion();
+    void ComputeFull();
+    void Refine();
+
+    void ConnectOperator(ImageOperator *op);
+    UPtr<ImageOperator> TakeOperator(uint8_t index);
+    void OperatorUpdated();
+    const CompiledPipeline & Compiled();
+    void ApplyOperators(Image & img, const std::string &stage);
+    uint64_t ChainFingerprint() const;
+    const Image & DisplayInput();
 
   private:
     Image m_inputImg;
+    ImagePyramid m_inputPyramid;
+    uint8_t m_workingLevel = 0;
     Image m_outputImg;
     UPtrV<ImageOperator> m_operators;
+    std::map<const ImageOperator *, EventProxy> m_connections;
+    CompiledPipeline m_compiled;
+    bool m_compiledDirty = true;
+
+    Quality m_outputQuality = Quality::Full;
+
+    OptT<RectU> m_roi;
+    uint32_t m_roiTargetWidth = 0;
+    uint32_t m_roiTargetHeight = 0;
+    UPtr<QTimer> m_fullTimer;
+
+    uint8_t m_updateDepth = 0;
+    bool m_updatePending = false;
+
+    bool m_progressive = false;
+    ResultCache *m_resultCache = nullptr;
+    UPtr<QTimer> m_refineTimer;
 
     std::string m_name = "unamed";
 };
 
+// Scoped pipeline update, a single computation is done on destruction if
+// any was requested while in scope.
+class PipelineUpdate
+{
+  public:
+    explicit PipelineUpdate(ImagePipeline &pipeline);
+    ~PipelineUpdate();
+
+    PipelineUpdate(const PipelineUpdate &) = delete;
+    PipelineUpdate& operator=(const PipelineUpdate &) = delete;
+
+  private:
+    ImagePipeline &m_pipeline;
+};
+
 
 template <typename T>
 T * ImagePipeline::AddOperator()
 {
     UPtr<ImageOperator> & op = m_operators.emplace_back(new T());
-    op->Subscribe<ImageOperator::Update>(std::bind(&ImagePipeline::Compute, this) );
+    ConnectOperator(op.get());
 
-    Compute();
+    OperatorUpdated();
 
     return static_cast<T *>(op.get());
 }
\ No newline at end of file
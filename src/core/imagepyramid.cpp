@@ -0,0 +1,178 @@
+#include "imagepyramid.h"
+
+#include <algorithm>
+
+#include <QtCore/QDebug>
+
+#include <utils/chrono.h>
+#include <utils/parallel.h>
+
+
+// ----------------------------------------------------------------------------
+
+static Image Downsample(const Image &src)
+{
+    uint32_t w = ImagePyramid::LevelSize(src.width(), 1);
+    uint32_t h = ImagePyramid::LevelSize(src.height(), 1);
+
+    if (src.type() != PixelType::Float || src.cached())
+        return src.resize(w, h, false, "box");
+
+    uint8_t c = src.channels();
+    Image dst = Image::Allocate(w, h, c);
+
+    const float *in = src.pixels_asfloat();
+    float *out = dst.pixels_asfloat();
+    uint64_t inStride = uint64_t(src.width()) * c;
+    uint64_t outStride = uint64_t(w) * c;
+    uint32_t xmax = src.width() - 1;
+    uint32_t ymax = src.height() - 1;
+
+    ParallelFor(0, h, [=](int64_t begin, int64_t end) {
+        for (int64_t y = begin; y < end; ++y) {
+            const float *r0 = in + std::min<uint32_t>(2 * y, ymax) * inStride;
+            const float *r1 = in + std::min<uint32_t>(2 * y + 1, ymax) * inStride;
+            float *o = out + y * outStride;
+
+            for (uint32_t x = 0; x < w; ++x) {
+                uint64_t x0 = std::min<uint32_t>(2 * x, xmax) * c;
+                uint64_t x1 = std::min<uint32_t>(2 * x + 1, xmax) * c;
+                for (uint8_t i = 0; i < c; ++i)
+                    o[x * c + i] = 0.25f * (r0[x0 + i] + r0[x1 + i] + r1[x0 + i] + r1[x1 + i]);
+            }
+        }
+    }, 16);
+
+    return dst;
+}
+
+// ----------------------------------------------------------------------------
+
+ImagePyramid::ImagePyramid()
+{
+
+}
+
+ImagePyramid::ImagePyramid(const Image &base)
+{
+    reset(base);
+}
+
+void ImagePyramid::reset()
+{
+    m_base = nullptr;
+    m_levels.clear();
+}
+
+void ImagePyramid::reset(const Image &base)
+{
+    m_base = &base;
+    m_levels.clear();
+}
+
+uint8_t ImagePyramid::levels() const
+{
+    if (!m_base || !*m_base)
+        return 0;
+
+    return LevelCount(m_base->width(), m_base->height());
+}
+
+const Image &ImagePyramid::level(uint8_t index)
+{
+    index = std::min<uint8_t>(index, std::max(levels(), uint8_t(1)) - 1);
+    if (index == 0)
+        return *m_base;
+
+    if (m_levels.size() < index)
+        m_levels.resize(index);
+
+    if (!m_levels[index - 1]) {
+        Chrono c;
+        c.start();
+
+        // Start from the closest finer level already built
+        uint8_t from = index - 1;
+        while (from > 0 && !m_levels[from - 1])
+            --from;
+
+        // Out-of-core images are resampled in a single pass through the
+        // image cache, intermediate levels are not built
+        uint8_t first = from + 1;
+        if (from == 0 && m_base->cached()) {
+            m_levels[index - 1] = m_base->resize(
+                LevelSize(m_base->width(), index), LevelSize(m_base->height(), index),
+                false, "box");
+            first = index;
+        }
+        else {
+            for (uint8_t i = first; i <= index; ++i)
+                m_levels[i - 1] = Downsample(i == 1 ? *m_base : m_levels[i - 2]);
+        }
+
+        for (uint8_t i = first; i <= index; ++i) {
+            const Image &img = m_levels[i - 1];
+            qInfo() << "Pyramid level" << i << ":" << img.width() << "x"
+                    << img.height() << "-" << bytes(i) / 1024 << "KB";
+        }
+
+        qInfo() << "Build pyramid levels in :" << fixed << qSetRealNumberPrecision(2)
+                << c.ellapsed(Chrono::MILLISECONDS) << "msec, total"
+                << bytes() / 1024 << "KB.\n";
+    }
+
+    return m_levels[index - 1];
+}
+
+uint8_t ImagePyramid::levelFor(uint32_t w, uint32_t h) const
+{
+    if (!m_base || !*m_base)
+        return 0;
+
+    return LevelFor(m_base->width(), m_base->height(), w, h);
+}
+
+uint64_t ImagePyramid::bytes(uint8_t index) const
+{
+    if (index == 0)
+        return m_base && !m_base->cached() ? m_base->bytes() : 0;
+    if (index > m_levels.size())
+        return 0;
+
+    return m_levels[index - 1].bytes();
+}
+
+uint64_t ImagePyramid::bytes() const
+{
+    uint64_t total = 0;
+    for (const Image &img : m_levels)
+        total += img.bytes();
+
+    return total;
+}
+
+uint8_t ImagePyramid::LevelCount(uint32_t w, uint32_t h)
+{
+    uint8_t count = 1;
+    while (count < 32 && std::min(LevelSize(w, count), LevelSize(h, count)) >= MinSize)
+        ++count;
+
+    return count;
+}
+
+uint8_t ImagePyramid::LevelFor(uint32_t baseW, uint32_t baseH, uint32_t w, uint32_t h)
+{
+    uint8_t count = LevelCount(baseW, baseH);
+
+    uint8_t level = 0;
+    while (level + 1 < count && LevelSize(baseW, level + 1) >= w
+           && LevelSize(baseH, level + 1) >= h)
+        ++level;
+
+    return level;
+}
+
+uint32_t ImagePyramid::LevelSize(uint32_t size, uint8_t level)
+{
+    return std::max(size >> level, 1u);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "image.h"
+
+#include <vector>
+
+
+// Multi-resolution view of an image, level 0 is the image itself and each
+// following level halves both dimensions with a 2x2 box filter. Levels are
+// built on first access and kept until the pyramid is reset. For out-of-core
+// base images, the first level requested is resampled directly from the
+// image cache.
+//
+// The pyramid does not own its base image, which must outlive it (or the
+// pyramid must be reset when the base image changes).
+class ImagePyramid
+{
+  public:
+    ImagePyramid();
+    explicit ImagePyramid(const Image &base);
+
+  public:
+    void reset();
+    void reset(const Image &base);
+
+    uint8_t levels() const;
+    const Image &level(uint8_t index);
+
+    // Coarsest level whose dimensions are at least w x h
+    uint8_t levelFor(uint32_t w, uint32_t h) const;
+
+    // Memory used by a level, and by all the levels built so far (base
+    // image excluded)
+    uint64_t bytes(uint8_t index) const;
+    uint64_t bytes() const;
+
+  public:
+    static constexpr uint32_t MinSize = 16;
+
+    static uint8_t LevelCount(uint32_t w, uint32_t h);
+    static uint8_t LevelFor(uint32_t baseW, uint32_t baseH, uint32_t w, uint32_t h);
+    static uint32_t LevelSize(uint32_t size, uint8_t level);
+
+  private:
+    const Image *m_base = nullptr;
+    std::vector<Image> m_levels;
+};
@@ -0,0 +1,114 @@
+#include "imagestream.h"
+
+#include <QtCore/QDebug>
+
+#include <OpenImageIO/imageio.h>
+
+#include <utils/trace.h>
+
+using namespace OIIO;
+
+
+// Defined in image.cpp
+TypeDesc PixelTypeToTypeDesc(PixelType type);
+
+// ----------------------------------------------------------------------------
+
+ImageReader::ImageReader(const std::string &path)
+: m_input(ImageInput::open(path))
+{
+    if (!m_input)
+        qWarning() << "Could not open image !" << QString::fromStdString(path);
+}
+
+ImageReader::~ImageReader()
+{
+
+}
+
+uint32_t ImageReader::width() const
+{
+    return m_input ? m_input->spec().width : 0;
+}
+
+uint32_t ImageReader::height() const
+{
+    return m_input ? m_input->spec().height : 0;
+}
+
+Image ImageReader::read(uint32_t ybegin, uint32_t yend)
+{
+    if (!m_input)
+        return Image();
+
+    TraceScope trace("io", "Read scanlines");
+    return Image::FromScanlines(*m_input, ybegin, yend);
+}
+
+ImageReader::operator bool() const
+{
+    return m_input != nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+ImageWriter::ImageWriter(const std::string &path, uint32_t width, uint32_t height,
+                         uint8_t channels, PixelType type)
+: m_output(ImageOutput::create(path))
+{
+    if (!m_output) {
+        qWarning() << "Could not create image !" << QString::fromStdString(path);
+        return;
+    }
+
+    ImageSpec spec(width, height, channels, PixelTypeToTypeDesc(type));
+    if (channels == 4)
+        spec.alpha_channel = 3;
+
+    if (!m_output->open(path, spec)) {
+        qWarning() << "Could not create image !" << QString::fromStdString(m_output->geterror());
+        m_output.reset();
+    }
+}
+
+ImageWriter::~ImageWriter()
+{
+    close();
+}
+
+bool ImageWriter::write(const Image &img, uint32_t row, uint32_t ybegin, uint32_t count)
+{
+    if (!m_output)
+        return false;
+
+    TraceScope trace("io", "Write scanlines");
+    Image converted;
+    if (img.type() != PixelType::Float)
+        converted = img.to_type(PixelType::Float);
+
+    const Image &src = converted ? converted : img;
+    const float *pix = src.pixels_asfloat() + uint64_t(row) * src.width() * src.channels();
+
+    if (!m_output->write_scanlines(ybegin, ybegin + count, 0, TypeDesc::FLOAT, pix)) {
+        qWarning() << "Could not write image !" << QString::fromStdString(m_output->geterror());
+        return false;
+    }
+
+    return true;
+}
+
+bool ImageWriter::close()
+{
+    if (!m_output)
+        return false;
+
+    TraceScope trace("io", "Close output");
+    bool res = m_output->close();
+    m_output.reset();
+    return res;
+}
+
+ImageWriter::operator bool() const
+{
+    return m_output != nullptr;
+}
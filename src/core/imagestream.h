@@ -0,0 +1,46 @@
+#pragma once
+
+#include "image.h"
+
+#include <string>
+
+
+// Sequential access to image files by stripes of rows, so that images can be
+// processed without holding the whole frame in memory.
+class ImageReader
+{
+  public:
+    explicit ImageReader(const std::string &path);
+    ~ImageReader();
+
+  public:
+    uint32_t width() const;
+    uint32_t height() const;
+
+    // Rows [ybegin, yend) in working format
+    Image read(uint32_t ybegin, uint32_t yend);
+
+    explicit operator bool() const;
+
+  private:
+    UPtr<OIIO::ImageInput> m_input;
+};
+
+class ImageWriter
+{
+  public:
+    ImageWriter(const std::string &path, uint32_t width, uint32_t height, uint8_t channels,
+                PixelType type = PixelType::Uint16);
+    ~ImageWriter();
+
+  public:
+    // Writes count rows of img, starting at row, as the next rows of the file
+    // beginning at ybegin. Rows must be written in order.
+    bool write(const Image &img, uint32_t row, uint32_t ybegin, uint32_t count);
+    bool close();
+
+    explicit operator bool() const;
+
+  private:
+    UPtr<OIIO::ImageOutput> m_output;
+};
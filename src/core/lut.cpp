@@ -0,0 +1,249 @@
+#include "lut.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtCore/QDebug>
+
+#include <utils/chrono.h>
+#include <utils/parallel.h>
+
+#include "image.h"
+
+
+// Log2 shaper range, in stops around mid grey
+constexpr float ShaperGrey = 0.18f;
+constexpr float ShaperMinStop = -8.f;
+constexpr float ShaperMaxStop = 8.f;
+
+LUT3D::LUT3D()
+{
+
+}
+
+LUT3D::LUT3D(uint32_t size, LUTShaper shaper)
+: m_size(size), m_shaper(shaper), m_data(uint64_t(size) * size * size * 3, 0.f)
+{
+
+}
+
+LUT3D::operator bool() const
+{
+    return m_size >= 2;
+}
+
+uint32_t LUT3D::size() const
+{
+    return m_size;
+}
+
+LUTShaper LUT3D::shaper() const
+{
+    return m_shaper;
+}
+
+uint64_t LUT3D::bytes() const
+{
+    return m_data.size() * sizeof(float);
+}
+
+float *LUT3D::data()
+{
+    return m_data.data();
+}
+
+float const *LUT3D::data() const
+{
+    return m_data.data();
+}
+
+float LUT3D::shape(float v) const
+{
+    if (m_shaper == LUTShaper::Log2) {
+        float stop = std::log2(std::max(v, 1e-10f) / ShaperGrey);
+        return (stop - ShaperMinStop) / (ShaperMaxStop - ShaperMinStop);
+    }
+
+    return v;
+}
+
+float LUT3D::unshape(float v) const
+{
+    if (m_shaper == LUTShaper::Log2)
+        return ShaperGrey * std::exp2(ShaperMinStop + v * (ShaperMaxStop - ShaperMinStop));
+
+    return v;
+}
+
+void LUT3D::evaluate(const float *rgb, float *out) const
+{
+    float coords[3] = { shape(rgb[0]), shape(rgb[1]), shape(rgb[2]) };
+    interpolate(coords, out);
+}
+
+void LUT3D::interpolate(const float *coords, float *out) const
+{
+    const uint32_t n = m_size;
+    float f[3];
+    uint32_t i[3];
+    for (int k = 0; k < 3; ++k) {
+        float v = std::clamp(coords[k], 0.f, 1.f) * (n - 1);
+        if (!(v >= 0.f))
+            v = 0.f;
+        i[k] = std::min(uint32_t(v), n - 2);
+        f[k] = v - i[k];
+    }
+
+    // Lattice corners, red fastest
+    const uint64_t dr = 3;
+    const uint64_t dg = uint64_t(n) * 3;
+    const uint64_t db = uint64_t(n) * n * 3;
+    const float *c000 = m_data.data() + i[0] * dr + i[1] * dg + i[2] * db;
+    const float *c111 = c000 + dr + dg + db;
+
+    float fr = f[0], fg = f[1], fb = f[2];
+    const float *c1, *c2;
+    float w0, w1, w2, w3;
+
+    if (fr > fg) {
+        if (fg > fb) {
+            c1 = c000 + dr; c2 = c000 + dr + dg;
+            w0 = 1.f - fr; w1 = fr - fg; w2 = fg - fb; w3 = fb;
+        }
+        else if (fr > fb) {
+            c1 = c000 + dr; c2 = c000 + dr + db;
+            w0 = 1.f - fr; w1 = fr - fb; w2 = fb - fg; w3 = fg;
+        }
+        else {
+            c1 = c000 + db; c2 = c000 + dr + db;
+            w0 = 1.f - fb; w1 = fb - fr; w2 = fr - fg; w3 = fg;
+        }
+    }
+    else {
+        if (fb > fg) {
+            c1 = c000 + db; c2 = c000 + dg + db;
+            w0 = 1.f - fb; w1 = fb - fg; w2 = fg - fr; w3 = fr;
+        }
+        else if (fb > fr) {
+            c1 = c000 + dg; c2 = c000 + dg + db;
+            w0 = 1.f - fg; w1 = fg - fb; w2 = fb - fr; w3 = fr;
+        }
+        else {
+            c1 = c000 + dg; c2 = c000 + dr + dg;
+            w0 = 1.f - fg; w1 = fg - fr; w2 = fr - fb; w3 = fb;
+        }
+    }
+
+    for (int k = 0; k < 3; ++k)
+        out[k] = w0 * c000[k] + w1 * c1[k] + w2 * c2[k] + w3 * c111[k];
+}
+
+void LUT3D::apply(Image &img) const
+{
+    if (!*this || img.channels() < 3)
+        return;
+
+    uint8_t c = img.channels();
+    uint32_t w = img.width();
+    float *pixels = img.pixels_asfloat();
+
+    ParallelFor(0, img.height(), [&](int64_t ybegin, int64_t yend) {
+        for (int64_t y = ybegin; y < yend; ++y) {
+            float *p = pixels + uint64_t(y) * w * c;
+            for (uint32_t x = 0; x < w; ++x, p += c) {
+                float rgb[3] = { p[0], p[1], p[2] };
+                evaluate(rgb, p);
+            }
+        }
+    }, 16);
+}
+
+LUT3D LUT3D::resample(uint32_t size) const
+{
+    if (!*this || size < 2)
+        return LUT3D();
+
+    Chrono c;
+    c.start();
+
+    // Nodes share the shaper space, no need to go through linear values
+    LUT3D res(size, m_shaper);
+    float *out = res.data();
+    float step = 1.f / (size - 1);
+
+    ParallelFor(0, size, [&](int64_t bbegin, int64_t bend) {
+        for (int64_t b = bbegin; b < bend; ++b)
+            for (uint32_t g = 0; g < size; ++g)
+                for (uint32_t r = 0; r < size; ++r) {
+                    float coords[3] = { r * step, g * step, b * step };
+                    uint64_t i = r + uint64_t(g) * size + uint64_t(b) * size * size;
+                    interpolate(coords, out + i * 3);
+                }
+    });
+
+    qInfo() << "Resample LUT" << m_size << "to" << size << ":" << fixed << qSetRealNumberPrecision(2)
+            << c.ellapsed(Chrono::MILLISECONDS) << "msec.\n";
+
+    return res;
+}
+
+float LUT3D::difference(const LUT3D &other) const
+{
+    if (!*this || !other)
+        return INFINITY;
+
+    const uint32_t n = m_size;
+    float step = 1.f / (n - 1);
+    std::vector<float> errors(n, 0.f);
+
+    ParallelFor(0, n, [&](int64_t bbegin, int64_t bend) {
+        for (int64_t b = bbegin; b < bend; ++b)
+            for (uint32_t g = 0; g < n; ++g)
+                for (uint32_t r = 0; r < n; ++r) {
+                    float coords[3] = { r * step, g * step, b * step };
+                    float v[3];
+                    if (other.m_shaper == m_shaper) {
+                        other.interpolate(coords, v);
+                    }
+                    else {
+                        float rgb[3] = { unshape(coords[0]), unshape(coords[1]), unshape(coords[2]) };
+                        other.evaluate(rgb, v);
+                    }
+
+                    const float *ref = m_data.data() + (r + uint64_t(g) * n + uint64_t(b) * n * n) * 3;
+                    for (int k = 0; k < 3; ++k)
+                        errors[b] = std::max(errors[b], std::abs(v[k] - ref[k]));
+                }
+    });
+
+    return *std::max_element(errors.begin(), errors.end());
+}
+
+LUT3D LUT3D::Bake(const FuncT<void(Image &)> &process, uint32_t size, LUTShaper shaper)
+{
+    Chrono c;
+    c.start();
+
+    LUT3D lut(size, shaper);
+    if (!lut)
+        return LUT3D();
+
+    // Lattice nodes are evenly spaced in the shaper space
+    Image lattice = Image::Lattice(size);
+    float *pix = lattice.pixels_asfloat();
+    uint64_t count = uint64_t(size) * size * size;
+
+    if (shaper != LUTShaper::Linear)
+        for (uint64_t i = 0; i < count * 3; ++i)
+            pix[i] = lut.unshape(pix[i]);
+
+    process(lattice);
+
+    pix = lattice.pixels_asfloat();
+    std::copy(pix, pix + count * 3, lut.data());
+
+    qInfo() << "Bake LUT" << size << ":" << fixed << qSetRealNumberPrecision(2)
+            << c.ellapsed(Chrono::MILLISECONDS) << "msec.\n";
+
+    return lut;
+}
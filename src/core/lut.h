@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include <utils/generic.h>
+
+
+class Image;
+
+// Input encoding of a 3D LUT lattice. Linear covers [0, 1], Log2 covers
+// scene linear values from 8 stops below to 8 stops above mid grey.
+enum class LUTShaper
+{
+    Linear,
+    Log2
+};
+
+// RGB 3D LUT, lattice values are stored red fastest (as in .cube files)
+// and evaluated with tetrahedral interpolation.
+class LUT3D
+{
+  public:
+    LUT3D();
+    LUT3D(uint32_t size, LUTShaper shaper = LUTShaper::Linear);
+
+  public:
+    explicit operator bool() const;
+
+    uint32_t size() const;
+    LUTShaper shaper() const;
+    uint64_t bytes() const;
+
+    // size^3 RGB values
+    float *data();
+    float const *data() const;
+
+    // Shaper encoding of a linear value to lattice coordinates in [0, 1],
+    // and back
+    float shape(float v) const;
+    float unshape(float v) const;
+
+    void evaluate(const float *rgb, float *out) const;
+    void apply(Image &img) const;
+
+    // Same LUT on a lattice of another size, evaluated in parallel over the
+    // new lattice
+    LUT3D resample(uint32_t size) const;
+    // Largest difference between the lattice values and other evaluated at
+    // the same points, the error of a resampled LUT
+    float difference(const LUT3D &other) const;
+
+  public:
+    // Bakes a processing function, called once on a lattice image
+    static LUT3D Bake(const FuncT<void(Image &)> &process, uint32_t size,
+                      LUTShaper shaper = LUTShaper::Linear);
+
+  private:
+    // Evaluation at lattice coordinates in [0, 1]
+    void interpolate(const float *coords, float *out) const;
+
+  private:
+    uint32_t m_size = 0;
+    LUTShaper m_shaper = LUTShaper::Linear;
+    std::vector<float> m_data;
+};
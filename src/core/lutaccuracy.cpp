@@ -0,0 +1,248 @@
+#include "lutaccuracy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <random>
+
+#include <QtCore/QDebug>
+
+#include <utils/chrono.h>
+#include <utils/parallel.h>
+
+#include "image.h"
+
+
+Image LUTSamples(uint32_t count, LUTShaper shaper)
+{
+    // Shaper coordinates in [0, 1] are converted to linear values at the end
+    std::vector<std::array<float, 3>> coords;
+    coords.reserve(count + 8192);
+
+    std::mt19937 rng(20190417);
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+    for (uint32_t i = 0; i < count; ++i)
+        coords.push_back({ uniform(rng), uniform(rng), uniform(rng) });
+
+    for (int i = 0; i < 8; ++i)
+        coords.push_back({ float(i & 1), float((i >> 1) & 1), float((i >> 2) & 1) });
+
+    const uint32_t ramp = 1024;
+    for (uint32_t i = 0; i < ramp; ++i) {
+        float v = 1.f * i / (ramp - 1);
+        coords.push_back({ v, v, v });
+        coords.push_back({ v, 0.f, 0.f });
+        coords.push_back({ 0.f, v, 0.f });
+        coords.push_back({ 0.f, 0.f, v });
+        coords.push_back({ v, v, 0.f });
+        coords.push_back({ 0.f, v, v });
+        coords.push_back({ v, 0.f, v });
+    }
+
+    // Nodes and cell centres of the usual lattice sizes, on the diagonal
+    for (uint32_t size : { 17, 33, 65 })
+        for (uint32_t i = 0; i < 2 * size - 1; ++i) {
+            float v = 0.5f * i / (size - 1);
+            coords.push_back({ v, v, v });
+        }
+
+    for (float v : { -0.01f, -0.001f, 1.001f, 1.01f }) {
+        coords.push_back({ v, 0.5f, 0.5f });
+        coords.push_back({ 0.5f, v, 0.5f });
+        coords.push_back({ 0.5f, 0.5f, v });
+        coords.push_back({ v, v, v });
+    }
+
+    const uint32_t width = 1024;
+    uint32_t height = (coords.size() + width - 1) / width;
+    Image img = Image::Allocate(width, height, 3);
+
+    LUT3D shaping(2, shaper);
+    float *pix = img.pixels_asfloat();
+    std::fill(pix, pix + img.count() * 3, 0.f);
+    for (uint64_t i = 0; i < coords.size(); ++i)
+        for (int c = 0; c < 3; ++c)
+            pix[i * 3 + c] = shaping.unshape(coords[i][c]);
+
+    return img;
+}
+
+void SRGBToLab(const float *rgb, float *lab)
+{
+    // sRGB decoding, sign preserving for out of range values
+    float lin[3];
+    for (int c = 0; c < 3; ++c) {
+        float v = std::abs(rgb[c]);
+        v = v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+        lin[c] = std::copysign(v, rgb[c]);
+    }
+
+    // Rec.709 primaries to XYZ, normalized to the D65 white
+    float x = (0.4124f * lin[0] + 0.3576f * lin[1] + 0.1805f * lin[2]) / 0.95047f;
+    float y = (0.2126f * lin[0] + 0.7152f * lin[1] + 0.0722f * lin[2]);
+    float z = (0.0193f * lin[0] + 0.1192f * lin[1] + 0.9505f * lin[2]) / 1.08883f;
+
+    auto f = [](float t) {
+        return t > 216.f / 24389.f ? std::cbrt(t) : (24389.f / 27.f * t + 16.f) / 116.f;
+    };
+
+    float fx = f(x), fy = f(y), fz = f(z);
+    lab[0] = 116.f * fy - 16.f;
+    lab[1] = 500.f * (fx - fy);
+    lab[2] = 200.f * (fy - fz);
+}
+
+float DeltaE2000(const float *lab1, const float *lab2)
+{
+    // Sharma, Wu, Dalal : The CIEDE2000 Color-Difference Formula
+    const double pi = 3.14159265358979323846;
+    auto deg = [pi](double rad) { return rad * 180.0 / pi; };
+    auto rad = [pi](double deg) { return deg * pi / 180.0; };
+
+    double L1 = lab1[0], a1 = lab1[1], b1 = lab1[2];
+    double L2 = lab2[0], a2 = lab2[1], b2 = lab2[2];
+
+    double C1 = std::hypot(a1, b1);
+    double C2 = std::hypot(a2, b2);
+    double Cm = 0.5 * (C1 + C2);
+    double Cm7 = std::pow(Cm, 7.0);
+    double G = 0.5 * (1.0 - std::sqrt(Cm7 / (Cm7 + std::pow(25.0, 7.0))));
+
+    double a1p = (1.0 + G) * a1;
+    double a2p = (1.0 + G) * a2;
+    double C1p = std::hypot(a1p, b1);
+    double C2p = std::hypot(a2p, b2);
+
+    auto hue = [&deg](double b, double a) {
+        if (a == 0.0 && b == 0.0)
+            return 0.0;
+        double h = deg(std::atan2(b, a));
+        return h < 0.0 ? h + 360.0 : h;
+    };
+    double h1p = hue(b1, a1p);
+    double h2p = hue(b2, a2p);
+
+    double dLp = L2 - L1;
+    double dCp = C2p - C1p;
+
+    double dhp = 0.0;
+    if (C1p * C2p != 0.0) {
+        dhp = h2p - h1p;
+        if (dhp > 180.0)
+            dhp -= 360.0;
+        else if (dhp < -180.0)
+            dhp += 360.0;
+    }
+    double dHp = 2.0 * std::sqrt(C1p * C2p) * std::sin(rad(dhp) / 2.0);
+
+    double Lpm = 0.5 * (L1 + L2);
+    double Cpm = 0.5 * (C1p + C2p);
+
+    double hpm = h1p + h2p;
+    if (C1p * C2p != 0.0) {
+        if (std::abs(h1p - h2p) <= 180.0)
+            hpm = 0.5 * (h1p + h2p);
+        else if (h1p + h2p < 360.0)
+            hpm = 0.5 * (h1p + h2p + 360.0);
+        else
+            hpm = 0.5 * (h1p + h2p - 360.0);
+    }
+
+    double T = 1.0
+        - 0.17 * std::cos(rad(hpm - 30.0))
+        + 0.24 * std::cos(rad(2.0 * hpm))
+        + 0.32 * std::cos(rad(3.0 * hpm + 6.0))
+        - 0.20 * std::cos(rad(4.0 * hpm - 63.0));
+
+    double dTheta = 30.0 * std::exp(-std::pow((hpm - 275.0) / 25.0, 2.0));
+    double Cpm7 = std::pow(Cpm, 7.0);
+    double Rc = 2.0 * std::sqrt(Cpm7 / (Cpm7 + std::pow(25.0, 7.0)));
+    double Lpm50 = (Lpm - 50.0) * (Lpm - 50.0);
+    double Sl = 1.0 + 0.015 * Lpm50 / std::sqrt(20.0 + Lpm50);
+    double Sc = 1.0 + 0.045 * Cpm;
+    double Sh = 1.0 + 0.015 * Cpm * T;
+    double Rt = -std::sin(rad(2.0 * dTheta)) * Rc;
+
+    double l = dLp / Sl, c = dCp / Sc, h = dHp / Sh;
+    return std::sqrt(l * l + c * c + h * h + Rt * c * h);
+}
+
+LUTAccuracy MeasureLUTAccuracy(const FuncT<void(Image &)> &process, uint32_t size,
+                               LUTShaper shaper, uint32_t samples)
+{
+    LUTAccuracy res = {};
+    res.size = size;
+    res.shaper = shaper;
+
+    Chrono c;
+    c.start();
+    LUT3D lut = LUT3D::Bake(process, size, shaper);
+    res.bakeTime = c.ellapsed(Chrono::MILLISECONDS);
+    if (!lut)
+        return res;
+
+    Image exact = LUTSamples(samples, shaper);
+    Image approx = exact;
+
+    c.start();
+    process(exact);
+    res.exactTime = c.ellapsed(Chrono::MILLISECONDS);
+
+    c.start();
+    lut.apply(approx);
+    res.lutTime = c.ellapsed(Chrono::MILLISECONDS);
+
+    // Padding pixels of the last row are measured too, they are valid
+    // (black) samples
+    res.samples = exact.count();
+    const float *pe = exact.pixels_asfloat();
+    const float *pa = approx.pixels_asfloat();
+    uint8_t ce = exact.channels();
+    uint8_t ca = approx.channels();
+
+    std::mutex mutex;
+    double sumDeltaE = 0.0;
+    std::array<double, 3> sumError = { 0.0, 0.0, 0.0 };
+
+    ParallelFor(0, res.samples, [&](int64_t begin, int64_t end) {
+        double localDeltaE = 0.0, localMaxDeltaE = 0.0;
+        std::array<double, 3> localError = { 0.0, 0.0, 0.0 };
+        std::array<float, 3> localMaxError = { 0.f, 0.f, 0.f };
+
+        for (int64_t i = begin; i < end; ++i) {
+            const float *e = pe + i * ce;
+            const float *a = pa + i * ca;
+
+            float labE[3], labA[3];
+            SRGBToLab(e, labE);
+            SRGBToLab(a, labA);
+            float de = DeltaE2000(labE, labA);
+            localDeltaE += de;
+            localMaxDeltaE = std::max<double>(localMaxDeltaE, de);
+
+            for (int k = 0; k < 3; ++k) {
+                float d = std::abs(e[k] - a[k]);
+                localError[k] += d;
+                localMaxError[k] = std::max(localMaxError[k], d);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        sumDeltaE += localDeltaE;
+        res.maxDeltaE = std::max<float>(res.maxDeltaE, localMaxDeltaE);
+        for (int k = 0; k < 3; ++k) {
+            sumError[k] += localError[k];
+            res.maxError[k] = std::max(res.maxError[k], localMaxError[k]);
+        }
+    }, 4096);
+
+    res.meanDeltaE = sumDeltaE / std::max<uint64_t>(res.samples, 1);
+    for (int k = 0; k < 3; ++k)
+        res.meanError[k] = sumError[k] / std::max<uint64_t>(res.samples, 1);
+
+    qInfo() << "LUT accuracy" << size << (shaper == LUTShaper::Log2 ? "Log2" : "Linear")
+            << ": max dE" << fixed << qSetRealNumberPrecision(3) << res.maxDeltaE
+            << "mean dE" << res.meanDeltaE << "\n";
+
+    return res;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+
+#include <utils/generic.h>
+
+#include "lut.h"
+
+
+class Image;
+
+// Error of a baked 3D LUT against the exact processing it approximates.
+// Colour differences are CIE ΔE2000, outputs being taken as sRGB encoded
+// display values. Times are in msec.
+struct LUTAccuracy
+{
+    uint32_t size;
+    LUTShaper shaper;
+    uint64_t samples;
+
+    float maxDeltaE;
+    float meanDeltaE;
+    std::array<float, 3> maxError;
+    std::array<float, 3> meanError;
+
+    float bakeTime;
+    float exactTime;
+    float lutTime;
+};
+
+// Test inputs covering the shaper domain : uniform random samples (fixed
+// seed) followed by edge cases, lattice corners, neutral and primary
+// ramps, values on and halfway between lattice nodes, and slightly out of
+// domain values.
+Image LUTSamples(uint32_t count, LUTShaper shaper);
+
+float DeltaE2000(const float *lab1, const float *lab2);
+void SRGBToLab(const float *rgb, float *lab);
+
+// Bakes process to a LUT of the given size and shaper and compares both on
+// the test samples
+LUTAccuracy MeasureLUTAccuracy(const FuncT<void(Image &)> &process, uint32_t size,
+                               LUTShaper shaper, uint32_t samples = 1 << 20);
@@ -0,0 +1,625 @@
+#include "lutio.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStandardPaths>
+
+#include <OpenImageIO/imageio.h>
+
+#include <utils/chrono.h>
+#include <utils/hash.h>
+#include <utils/parallel.h>
+#include <utils/trace.h>
+
+
+// Entries formatted per chunk, each chunk being formatted by one thread
+constexpr uint64_t LUTChunkSize = 1 << 14;
+
+// Largest formatted float, sign, 7 integer digits, dot and 6 decimals
+constexpr uint64_t LUTFloatChars = 16;
+
+// Lines of a .cube table parsed per chunk
+constexpr uint64_t CubeChunkBytes = 1 << 20;
+
+// Magic and version of the binary format
+constexpr char LUTBinaryMagic[4] = { 'E', 'L', 'U', 'T' };
+constexpr uint32_t LUTBinaryVersion = 2;
+
+// Largest lattice accepted when reading
+constexpr uint32_t LUTMaxSize = 256;
+
+struct LUTBinaryHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t size;
+    uint32_t shaper;
+    uint32_t type;      // 0 float, 1 half
+    float domainMin[3];
+    float domainMax[3];
+};
+
+char *FormatFloat(char *out, float v)
+{
+    // Keeps the line well formed for any value
+    if (!std::isfinite(v) || std::abs(v) >= 1e7f)
+        v = std::isnan(v) ? 0.f : std::copysign(9999999.f, v);
+
+    return std::to_chars(out, out + LUTFloatChars, v, std::chars_format::fixed, 6).ptr;
+}
+
+char *FormatInt(char *out, int64_t v)
+{
+    return std::to_chars(out, out + 24, v).ptr;
+}
+
+// Formats count entries with format(i, out) -> end, in parallel chunks of
+// at most lineBytes per entry, then writes them in order after the header
+template <typename F>
+bool WriteLines(const std::string &path, const std::string &header, const std::string &footer,
+                uint64_t count, uint64_t lineBytes, F format)
+{
+    uint64_t chunkCount = (count + LUTChunkSize - 1) / LUTChunkSize;
+    std::vector<std::string> chunks(chunkCount);
+
+    ParallelFor(0, chunkCount, [&](int64_t begin, int64_t end) {
+        for (int64_t c = begin; c < end; ++c) {
+            uint64_t first = c * LUTChunkSize;
+            uint64_t last = std::min(first + LUTChunkSize, count);
+
+            std::string &chunk = chunks[c];
+            chunk.resize((last - first) * lineBytes);
+            char *out = chunk.data();
+            for (uint64_t i = first; i < last; ++i)
+                out = format(i, out);
+            chunk.resize(out - chunk.data());
+        }
+    });
+
+    FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+
+    bool res = std::fwrite(header.data(), 1, header.size(), f) == header.size();
+    for (auto & chunk : chunks)
+        res &= std::fwrite(chunk.data(), 1, chunk.size(), f) == chunk.size();
+    res &= std::fwrite(footer.data(), 1, footer.size(), f) == footer.size();
+
+    return (std::fclose(f) == 0) && res;
+}
+
+// Lattice offset of the i-th entry when blue changes fastest
+uint64_t BlueFastIndex(uint64_t i, uint32_t n)
+{
+    uint64_t r = i / (uint64_t(n) * n);
+    uint64_t g = (i / n) % n;
+    uint64_t b = i % n;
+    return r + g * n + b * n * n;
+}
+
+bool WriteCube(const LUT3D &lut, const std::string &path)
+{
+    const float *data = lut.data();
+    uint32_t n = lut.size();
+
+    std::string header =
+        "LUT_3D_SIZE " + std::to_string(n) + "\n"
+        "DOMAIN_MIN 0.000000 0.000000 0.000000\n"
+        "DOMAIN_MAX 1.000000 1.000000 1.000000\n"
+        "\n";
+
+    return WriteLines(path, header, "", uint64_t(n) * n * n, 3 * LUTFloatChars + 3, [data](uint64_t i, char *out) {
+        const float *v = data + i * 3;
+        out = FormatFloat(out, v[0]); *out++ = ' ';
+        out = FormatFloat(out, v[1]); *out++ = ' ';
+        out = FormatFloat(out, v[2]); *out++ = '\n';
+        return out;
+    });
+}
+
+bool WriteSpi3D(const LUT3D &lut, const std::string &path)
+{
+    const float *data = lut.data();
+    uint32_t n = lut.size();
+
+    std::string size = std::to_string(n);
+    std::string header = "SPILUT 1.0\n3 3\n" + size + " " + size + " " + size + "\n";
+
+    return WriteLines(path, header, "", uint64_t(n) * n * n, 3 * 4 + 3 * LUTFloatChars + 6, [data, n](uint64_t i, char *out) {
+        const float *v = data + i * 3;
+        out = FormatInt(out, i % n); *out++ = ' ';
+        out = FormatInt(out, (i / n) % n); *out++ = ' ';
+        out = FormatInt(out, i / (uint64_t(n) * n)); *out++ = ' ';
+        out = FormatFloat(out, v[0]); *out++ = ' ';
+        out = FormatFloat(out, v[1]); *out++ = ' ';
+        out = FormatFloat(out, v[2]); *out++ = '\n';
+        return out;
+    });
+}
+
+bool Write3DL(const LUT3D &lut, const std::string &path)
+{
+    const float *data = lut.data();
+    uint32_t n = lut.size();
+
+    // Lustre / Flame mesh header : input mesh bits (2^bits + 1 nodes) and
+    // 16 bits output. OCIO v1 ignores it and infers the output depth from
+    // the largest value, dark LUTs are read back too bright there.
+    uint32_t meshBits = 0;
+    while ((1u << meshBits) + 1 < n)
+        meshBits++;
+    std::string header = "3DMESH\nMesh " + std::to_string(meshBits) + " 16\n";
+
+    // 10 bits input mesh
+    for (uint32_t i = 0; i < n; ++i)
+        header += std::to_string(std::lround(1023.0 * i / (n - 1))) + (i + 1 < n ? " " : "\n");
+
+    auto quantize = [](float v) {
+        return std::lround(std::clamp(v, 0.f, 1.f) * 65535.f);
+    };
+
+    return WriteLines(path, header, "", uint64_t(n) * n * n, 3 * 6 + 3, [data, n, quantize](uint64_t i, char *out) {
+        const float *v = data + BlueFastIndex(i, n) * 3;
+        out = FormatInt(out, quantize(v[0])); *out++ = ' ';
+        out = FormatInt(out, quantize(v[1])); *out++ = ' ';
+        out = FormatInt(out, quantize(v[2])); *out++ = '\n';
+        return out;
+    });
+}
+
+bool WriteCLF(const LUT3D &lut, const std::string &path)
+{
+    const float *data = lut.data();
+    uint32_t n = lut.size();
+
+    std::string size = std::to_string(n);
+    std::string header =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<ProcessList id=\"ELook Export\" compCLFversion=\"3.0\">\n"
+        "    <Description>Eclair Looks pipeline</Description>\n"
+        "    <LUT3D id=\"lut\" interpolation=\"tetrahedral\" inBitDepth=\"32f\" outBitDepth=\"32f\">\n"
+        "        <Array dim=\"" + size + " " + size + " " + size + " 3\">\n";
+    std::string footer =
+        "        </Array>\n"
+        "    </LUT3D>\n"
+        "</ProcessList>\n";
+
+    return WriteLines(path, header, footer, uint64_t(n) * n * n, 3 * LUTFloatChars + 3, [data, n](uint64_t i, char *out) {
+        const float *v = data + BlueFastIndex(i, n) * 3;
+        out = FormatFloat(out, v[0]); *out++ = ' ';
+        out = FormatFloat(out, v[1]); *out++ = ' ';
+        out = FormatFloat(out, v[2]); *out++ = '\n';
+        return out;
+    });
+}
+
+bool WriteBinary(const LUT3D &lut, const std::string &path, PixelType type)
+{
+    if (type != PixelType::Float && type != PixelType::Half)
+        return false;
+
+    LUTBinaryHeader header = {};
+    std::memcpy(header.magic, LUTBinaryMagic, sizeof(header.magic));
+    header.version = LUTBinaryVersion;
+    header.size = lut.size();
+    header.shaper = uint32_t(lut.shaper());
+    header.type = type == PixelType::Half ? 1 : 0;
+    for (int c = 0; c < 3; ++c) {
+        header.domainMin[c] = lut.unshape(0.f);
+        header.domainMax[c] = lut.unshape(1.f);
+    }
+
+    FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+
+    bool res = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    if (type == PixelType::Half) {
+        uint64_t count = lut.bytes() / sizeof(float);
+        std::vector<uint16_t> values(count);
+        OIIO::convert_types(OIIO::TypeDesc::FLOAT, lut.data(), OIIO::TypeDesc::HALF, values.data(), count);
+        res &= std::fwrite(values.data(), sizeof(uint16_t), count, f) == count;
+    }
+    else {
+        res &= std::fwrite(lut.data(), 1, lut.bytes(), f) == lut.bytes();
+    }
+
+    return (std::fclose(f) == 0) && res;
+}
+
+OptT<LUTFormat> LUTFormatFromPath(const std::string &path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos)
+        return {};
+
+    std::string ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    if (ext == "cube")
+        return LUTFormat::Cube;
+    else if (ext == "spi3d")
+        return LUTFormat::Spi3D;
+    else if (ext == "3dl")
+        return LUTFormat::ThreeDL;
+    else if (ext == "clf")
+        return LUTFormat::CLF;
+    else if (ext == "elut")
+        return LUTFormat::Binary;
+
+    return {};
+}
+
+std::vector<std::string> LUTFormatExtensions()
+{
+    return { "cube", "spi3d", "3dl", "clf", "elut" };
+}
+
+bool WriteLUT(const LUT3D &lut, const std::string &path, LUTFormat format, PixelType binaryType)
+{
+    if (!lut)
+        return false;
+
+    if (format != LUTFormat::Binary && lut.shaper() != LUTShaper::Linear) {
+        qWarning() << "Shaped LUT can only be written to the binary format :" << QString::fromStdString(path);
+        return false;
+    }
+
+    TraceScope trace("io", "Write LUT " + std::to_string(lut.size()));
+
+    Chrono c;
+    c.start();
+
+    bool res = false;
+    switch (format) {
+        case LUTFormat::Cube:
+            res = WriteCube(lut, path);
+            break;
+        case LUTFormat::Spi3D:
+            res = WriteSpi3D(lut, path);
+            break;
+        case LUTFormat::ThreeDL:
+            res = Write3DL(lut, path);
+            break;
+        case LUTFormat::CLF:
+            res = WriteCLF(lut, path);
+            break;
+        case LUTFormat::Binary:
+            res = WriteBinary(lut, path, binaryType);
+            break;
+    }
+
+    if (!res)
+        qWarning() << "Could not write LUT :" << QString::fromStdString(path);
+    else
+        qInfo() << "Write LUT" << lut.size() << ":" << fixed << qSetRealNumberPrecision(2)
+                << c.ellapsed(Chrono::MILLISECONDS) << "msec.\n";
+
+    return res;
+}
+
+bool WriteLUT(const LUT3D &lut, const std::string &path)
+{
+    auto format = LUTFormatFromPath(path);
+    if (!format) {
+        qWarning() << "Unknown LUT format :" << QString::fromStdString(path);
+        return false;
+    }
+
+    return WriteLUT(lut, path, *format);
+}
+
+LUT3D ReadBinaryLUT(const std::string &path)
+{
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(LUTBinaryHeader)))
+        return LUT3D();
+
+    const uchar *map = file.map(0, file.size());
+    if (!map)
+        return LUT3D();
+
+    LUTBinaryHeader header;
+    std::memcpy(&header, map, sizeof(header));
+
+    bool valid = std::memcmp(header.magic, LUTBinaryMagic, sizeof(header.magic)) == 0
+        && header.version == LUTBinaryVersion
+        && header.size >= 2 && header.size <= LUTMaxSize
+        && header.shaper <= uint32_t(LUTShaper::Log2)
+        && header.type <= 1;
+
+    uint64_t count = uint64_t(header.size) * header.size * header.size * 3;
+    uint64_t bytes = count * (header.type == 1 ? sizeof(uint16_t) : sizeof(float));
+    if (!valid || uint64_t(file.size()) < sizeof(header) + bytes) {
+        qWarning() << "Invalid binary LUT :" << QString::fromStdString(path);
+        return LUT3D();
+    }
+
+    LUT3D lut(header.size, LUTShaper(header.shaper));
+    const uchar *values = map + sizeof(header);
+    if (header.type == 1)
+        OIIO::convert_types(OIIO::TypeDesc::HALF, values, OIIO::TypeDesc::FLOAT, lut.data(), count);
+    else
+        std::memcpy(lut.data(), values, bytes);
+
+    return lut;
+}
+
+const char *SkipBlanks(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+    return p;
+}
+
+const char *NextLine(const char *p, const char *end)
+{
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    return eol ? eol + 1 : end;
+}
+
+// Neither blank nor a comment
+bool IsDataLine(const char *p, const char *end)
+{
+    p = SkipBlanks(p, end);
+    return p < end && *p != '\n' && *p != '\r' && *p != '#';
+}
+
+const char *ParseFloat(const char *p, const char *end, float &v)
+{
+    p = SkipBlanks(p, end);
+    if (p < end && *p == '+')
+        ++p;
+
+    auto [ptr, ec] = std::from_chars(p, end, v);
+    return ec == std::errc() ? ptr : nullptr;
+}
+
+LUT3D ReadCube(const std::string &path)
+{
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+        return LUT3D();
+
+    const char *begin = reinterpret_cast<const char *>(file.map(0, file.size()));
+    if (!begin)
+        return LUT3D();
+
+    TraceScope trace("io", "Read cube");
+    const char *end = begin + file.size();
+
+    // Header, keywords until the first number
+    uint32_t size = 0;
+    const char *data = end;
+    for (const char *line = begin; line < end; line = NextLine(line, end)) {
+        if (!IsDataLine(line, end))
+            continue;
+
+        const char *p = SkipBlanks(line, end);
+        if (std::isdigit(static_cast<unsigned char>(*p)) || *p == '-' || *p == '+' || *p == '.') {
+            data = line;
+            break;
+        }
+
+        const char *eol = NextLine(p, end);
+        std::string_view key(p, std::find_if(p, eol, [](char c) { return std::isspace(static_cast<unsigned char>(c)); }) - p);
+        p += key.size();
+
+        if (key == "LUT_3D_SIZE") {
+            if (std::from_chars(SkipBlanks(p, eol), eol, size).ec != std::errc())
+                return LUT3D();
+        }
+        else if (key == "DOMAIN_MIN" || key == "DOMAIN_MAX") {
+            float expected = key == "DOMAIN_MIN" ? 0.f : 1.f;
+            for (int c = 0; c < 3; ++c) {
+                float v = 0.f;
+                p = p ? ParseFloat(p, eol, v) : nullptr;
+                if (!p || v != expected)
+                    return LUT3D();
+            }
+        }
+        else if (key != "TITLE") {
+            return LUT3D();
+        }
+    }
+
+    if (size < 2 || size > LUTMaxSize)
+        return LUT3D();
+
+    // Chunks start on a line, their first entry index is known once lines
+    // of the previous chunks are counted
+    std::vector<const char *> chunks = { data };
+    while (chunks.back() < end) {
+        const char *next = std::min(chunks.back() + CubeChunkBytes, end);
+        chunks.push_back(next < end ? NextLine(next, end) : end);
+    }
+    int64_t chunkCount = chunks.size() - 1;
+
+    std::vector<uint64_t> firsts(chunkCount + 1, 0);
+    ParallelFor(0, chunkCount, [&](int64_t cbegin, int64_t cend) {
+        for (int64_t c = cbegin; c < cend; ++c)
+            for (const char *line = chunks[c]; line < chunks[c + 1]; line = NextLine(line, chunks[c + 1]))
+                firsts[c + 1] += IsDataLine(line, chunks[c + 1]);
+    });
+
+    for (int64_t c = 0; c < chunkCount; ++c)
+        firsts[c + 1] += firsts[c];
+
+    uint64_t count = uint64_t(size) * size * size;
+    if (firsts[chunkCount] != count) {
+        qWarning() << "Invalid cube, expected" << count << "entries :" << QString::fromStdString(path);
+        return LUT3D();
+    }
+
+    LUT3D lut(size);
+    std::atomic<bool> valid { true };
+    ParallelFor(0, chunkCount, [&](int64_t cbegin, int64_t cend) {
+        for (int64_t c = cbegin; c < cend && valid; ++c) {
+            float *out = lut.data() + firsts[c] * 3;
+            const char *chunkEnd = chunks[c + 1];
+            for (const char *line = chunks[c]; line < chunkEnd; line = NextLine(line, chunkEnd)) {
+                if (!IsDataLine(line, chunkEnd))
+                    continue;
+
+                const char *p = line;
+                for (int k = 0; k < 3 && p; ++k)
+                    p = ParseFloat(p, chunkEnd, *out++);
+                if (!p) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+    });
+
+    if (!valid) {
+        qWarning() << "Invalid cube values :" << QString::fromStdString(path);
+        return LUT3D();
+    }
+
+    return lut;
+}
+
+OptT<uint32_t> ProbeLUT3DSize(const std::string &path)
+{
+    auto format = LUTFormatFromPath(path);
+    if (!format)
+        return {};
+
+    std::ifstream ifs(path);
+    std::string line;
+
+    // Keywords come before the table, a number starts the table
+    if (*format == LUTFormat::Cube) {
+        OptT<uint32_t> size;
+        while (std::getline(ifs, line)) {
+            std::istringstream tokens(line);
+            std::string key;
+            if (!(tokens >> key) || key[0] == '#')
+                continue;
+
+            if (key == "LUT_3D_SIZE") {
+                uint32_t n = 0;
+                if (tokens >> n)
+                    size = n;
+            }
+            else if (key == "DOMAIN_MIN" || key == "DOMAIN_MAX") {
+                float v[3] = { 0.f, 0.f, 0.f };
+                float expected = key == "DOMAIN_MIN" ? 0.f : 1.f;
+                tokens >> v[0] >> v[1] >> v[2];
+                if (v[0] != expected || v[1] != expected || v[2] != expected)
+                    return {};
+            }
+            else if (key == "LUT_1D_SIZE" || key == "LUT_1D_INPUT_RANGE" || key == "LUT_3D_INPUT_RANGE") {
+                return {};
+            }
+            else if (std::isdigit(static_cast<unsigned char>(key[0])) || key[0] == '-' || key[0] == '.') {
+                break;
+            }
+        }
+
+        if (size && *size >= 2 && *size <= LUTMaxSize)
+            return size;
+    }
+    // Input mesh on the first numeric line
+    else if (*format == LUTFormat::ThreeDL) {
+        while (std::getline(ifs, line)) {
+            std::istringstream tokens(line);
+            std::string key;
+            if (!(tokens >> key) || !std::all_of(key.begin(), key.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+                continue;
+
+            uint32_t n = 1;
+            while (tokens >> key)
+                n++;
+            if (n > 3 && n <= LUTMaxSize)
+                return n;
+            break;
+        }
+    }
+    // Third line holds the lattice size of each axis
+    else if (*format == LUTFormat::Spi3D) {
+        for (int i = 0; i < 3 && std::getline(ifs, line); ++i)
+            ;
+
+        std::istringstream tokens(line);
+        uint32_t r = 0, g = 0, b = 0;
+        if (tokens >> r >> g >> b && r == g && g == b && r >= 2 && r <= LUTMaxSize)
+            return r;
+    }
+
+    return {};
+}
+
+std::string LUTCachePath(const std::string &source)
+{
+    QFileInfo info(QString::fromStdString(source));
+    if (!info.isFile())
+        return "";
+
+    QString folder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/lut";
+    if (!QDir().mkpath(folder))
+        return "";
+
+    // Source path hash first, so that entries of older versions of a file
+    // can be found and pruned (see CacheLUT)
+    std::string sourceKey = info.absoluteFilePath().toStdString();
+    std::string versionKey = std::to_string(info.lastModified().toMSecsSinceEpoch())
+        + ":" + std::to_string(info.size());
+    uint64_t sourceHash = XXH64(sourceKey.data(), sourceKey.size());
+    uint64_t versionHash = XXH64(versionKey.data(), versionKey.size(), sourceHash);
+
+    char name[48];
+    std::snprintf(name, sizeof(name), "%016llx-%016llx.elut",
+                  (unsigned long long) sourceHash, (unsigned long long) versionHash);
+    return (folder + "/" + name).toStdString();
+}
+
+LUT3D CachedLUT(const std::string &source)
+{
+    std::string path = LUTCachePath(source);
+    if (path.empty() || !QFileInfo::exists(QString::fromStdString(path)))
+        return LUT3D();
+
+    TraceScope trace("io", "Cached LUT");
+    return ReadBinaryLUT(path);
+}
+
+bool CacheLUT(const LUT3D &lut, const std::string &source)
+{
+    std::string path = LUTCachePath(source);
+    if (path.empty())
+        return false;
+
+    // Written aside then renamed, concurrent readers never see a partial
+    // file
+    std::string tmp = path + "." + std::to_string(QCoreApplication::applicationPid()) + ".tmp";
+    if (!WriteLUT(lut, tmp, LUTFormat::Binary) || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    // Entries of previous versions of the source are stale
+    QFileInfo entry(QString::fromStdString(path));
+    QString prefix = entry.fileName().section('-', 0, 0) + "-*.elut";
+    for (const QFileInfo &other : entry.dir().entryInfoList({ prefix }, QDir::Files))
+        if (other.fileName() != entry.fileName())
+            QFile::remove(other.absoluteFilePath());
+
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+
+#include <utils/generic.h>
+
+#include "image.h"
+#include "lut.h"
+
+
+// 3D LUT file formats :
+// - Cube : Resolve / Adobe .cube, red fastest
+// - Spi3D : Sony Pictures Imageworks .spi3d, explicit indices
+// - ThreeDL : Lustre / Flame .3dl, 16 bits integer output declared in the
+//   mesh header, blue fastest. OCIO v1 ignores the header and guesses the
+//   depth from the largest value : dark LUTs are read back too bright.
+// - CLF : Academy / ASC Common LUT Format (v3) .clf, blue fastest
+// - Binary : .elut, header followed by the raw float or half lattice, red
+//   fastest, meant to be memory mapped
+enum class LUTFormat
+{
+    Cube,
+    Spi3D,
+    ThreeDL,
+    CLF,
+    Binary
+};
+
+// Format from a file extension, and extensions of the supported formats
+OptT<LUTFormat> LUTFormatFromPath(const std::string &path);
+std::vector<std::string> LUTFormatExtensions();
+
+// Text formats only hold linear (unshaped) lattices, shaped LUTs can only
+// be written to the binary format. Lines are formatted in parallel chunks.
+// The binary format stores Float or Half values.
+bool WriteLUT(const LUT3D &lut, const std::string &path, LUTFormat format,
+              PixelType binaryType = PixelType::Float);
+bool WriteLUT(const LUT3D &lut, const std::string &path);
+
+// Binary LUT, the file is memory mapped and copied to the lattice
+LUT3D ReadBinaryLUT(const std::string &path);
+
+// Plain 3D .cube file (see ProbeLUT3DSize), the file is memory mapped and
+// parsed in parallel chunks of lines. Values are correctly rounded, as
+// parsed by OCIO. Other .cube files give an empty LUT.
+LUT3D ReadCube(const std::string &path);
+
+// Lattice size of a plain 3D LUT file (.cube, .3dl, .spi3d) over [0, 1]
+// read from its header, without 1D shaper nor custom domain. Other files
+// and formats have no size.
+OptT<uint32_t> ProbeLUT3DSize(const std::string &path);
+
+// Binary copies of text LUTs are kept in a cache folder, keyed by the
+// source path and modification time. Missing or stale entries give an
+// empty LUT, writing an entry removes those of older versions of the
+// source.
+std::string LUTCachePath(const std::string &source);
+LUT3D CachedLUT(const std::string &source);
+bool CacheLUT(const LUT3D &lut, const std::string &source);
@@ -0,0 +1,94 @@
+#include "resultcache.h"
+
+
+ResultCache::ResultCache()
+{
+
+}
+
+bool ResultCache::find(const Key &key, Image &img)
+{
+    if (m_budget == 0)
+        return false;
+
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return false;
+    }
+
+    // Most recently used entries are kept at the front
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    img = it->second->second;
+    ++m_hits;
+
+    return true;
+}
+
+void ResultCache::insert(const Key &key, const Image &img)
+{
+    uint64_t budget = uint64_t(m_budget) << 20;
+    if (!img || img.cached() || img.bytes() > budget)
+        return;
+
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_bytes -= it->second->second.bytes();
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    evict(budget - img.bytes());
+
+    m_entries.emplace_front(key, img);
+    m_index[key] = m_entries.begin();
+    m_bytes += img.bytes();
+}
+
+void ResultCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+void ResultCache::setBudget(uint32_t megabytes)
+{
+    m_budget = megabytes;
+    evict(uint64_t(m_budget) << 20);
+}
+
+uint32_t ResultCache::budget() const
+{
+    return m_budget;
+}
+
+uint64_t ResultCache::bytes() const
+{
+    return m_bytes;
+}
+
+uint64_t ResultCache::hits() const
+{
+    return m_hits;
+}
+
+uint64_t ResultCache::misses() const
+{
+    return m_misses;
+}
+
+float ResultCache::hitRate() const
+{
+    uint64_t lookups = m_hits + m_misses;
+    return lookups ? 100.f * m_hits / lookups : 0.f;
+}
+
+void ResultCache::evict(uint64_t budget)
+{
+    while (!m_entries.empty() && m_bytes > budget) {
+        m_bytes -= m_entries.back().second.bytes();
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <list>
+#include <map>
+#include <tuple>
+
+#include "image.h"
+
+
+// Least recently used cache of pipeline results, bounded by a memory
+// budget. Results are keyed by the content of the input image, the
+// fingerprint of the operator chain and the output resolution.
+class ResultCache
+{
+  public:
+    struct Key
+    {
+        uint64_t input;
+        uint64_t chain;
+        uint32_t width;
+        uint32_t height;
+
+        bool operator<(const Key &rhs) const
+        {
+            return std::tie(input, chain, width, height)
+                 < std::tie(rhs.input, rhs.chain, rhs.width, rhs.height);
+        }
+    };
+
+  public:
+    ResultCache();
+
+  public:
+    // Copies a cached result to img, returns false on a miss
+    bool find(const Key &key, Image &img);
+    void insert(const Key &key, const Image &img);
+    void clear();
+
+    // A zero budget disables the cache
+    void setBudget(uint32_t megabytes);
+    uint32_t budget() const;
+
+    uint64_t bytes() const;
+    uint64_t hits() const;
+    uint64_t misses() const;
+    float hitRate() const;
+
+  private:
+    void evict(uint64_t budget);
+
+  private:
+    using EntryT = std::pair<Key, Image>;
+
+    std::list<EntryT> m_entries;
+    std::map<Key, std::list<EntryT>::iterator> m_index;
+
+    uint32_t m_budget = 512;
+    uint64_t m_bytes = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <vector>
 
 #include <utils/generic.h>
@@ -11,6 +12,10 @@ enum class SideBySide { A, B };
 
 enum class Scale { Linear, Log };
 
+// Proxy results are approximations (reduced resolution or partial images)
+// and will be followed by a Full update.
+enum class Quality { Proxy, Full };
+
 // ----------------------------------------------------------------------------
 
 template <typename T>
@@ -24,6 +29,19 @@ using Point2F = Point2D<float>;
 
 // ----------------------------------------------------------------------------
 
+template <typename T>
+struct Rect
+{
+    T x;
+    T y;
+    T width;
+    T height;
+};
+
+using RectU = Rect<uint32_t>;
+
+// ----------------------------------------------------------------------------
+
 template <typename T>
 struct Color
 {
@@ -1,5 +1,6 @@
 #include "imageviewer.h"
 
+#include <cmath>
 #include <cstdlib>
 
 #include <QtCore/qmath.h>
@@ -42,6 +43,11 @@ ImageWidget::ImageWidget(QWidget *parent)
       m_textureB(QOpenGLTexture::Target2D), m_sliderPosition(0.f)
 {
     setAcceptDrops(true);
+
+    // Wait for the view to settle before notifying about viewport changes
+    m_viewTimer.setSingleShot(true);
+    m_viewTimer.setInterval(100);
+    QObject::connect(&m_viewTimer, &QTimer::timeout, [this]() { updateViewport(); });
 }
 
 void ImageWidget::mousePressEvent(QMouseEvent *event)
@@ -152,6 +158,15 @@ void ImageWidget::paintGL()
     p.drawLine(
         worldToWidget(QPointF(m_sliderPosition, -1.f)),
         worldToWidget(QPointF(m_sliderPosition, 1.f)));
+
+    // Notify the image is still being refined
+    if (m_quality == Quality::Proxy)
+        p.drawText(rect().adjusted(8, 8, -8, -8), Qt::AlignTop | Qt::AlignRight, "Preview");
+
+    if (viewMatrix() != m_lastViewMatrix) {
+        m_lastViewMatrix = viewMatrix();
+        m_viewTimer.start();
+    }
 }
 
 bool ImageWidget::hasImage() const
@@ -178,12 +193,13 @@ void ImageWidget::resetImage(const Image &img)
     doneCurrent();
 }
 
-void ImageWidget::updateImage(SideBySide sbs, const Image &img)
+void ImageWidget::updateImage(SideBySide sbs, const Image &img, Quality quality)
 {
+    QOpenGLTexture::TextureFormat textureFormat;
     QOpenGLTexture::PixelType pixelType;
     QOpenGLTexture::PixelFormat pixelFormat;
     std::array<QOpenGLTexture::SwizzleValue, 4> sw;
-    if (!guessPixelsParameters(img, pixelType, pixelFormat, sw))
+    if (!guessPixelsParameters(img, textureFormat, pixelType, pixelFormat, sw))
         return;
 
     QOpenGLTexture *texture = nullptr;
@@ -196,8 +212,28 @@ void ImageWidget::updateImage(SideBySide sbs, const Image &img)
             break;
     }
 
-    if (texture->width() != img.width() || texture->height() != img.height())
-        resetImage(img);
+    if (texture->width() != img.width() || texture->height() != img.height()) {
+        float texRatio = 1.0f * texture->width() / texture->height();
+        float imgRatio = 1.0f * img.width() / img.height();
+
+        // Same image at another resolution (ie. proxy), keep the current view
+        if (texture->isStorageAllocated() && std::abs(texRatio - imgRatio) < 0.01f) {
+            makeCurrent();
+            createTexture(*texture, img);
+            doneCurrent();
+        }
+        else {
+            resetImage(img);
+        }
+    }
+    else if (texture->format() != textureFormat) {
+        // Working format or precision changed
+        makeCurrent();
+        createTexture(*texture, img);
+        doneCurrent();
+    }
+
+    m_quality = quality;
 
     makeCurrent();
     texture->setData(pixelFormat, pixelType, img.pixels());
@@ -213,13 +249,51 @@ GLint ImageWidget::texture()
     return m_textureA.textureId();
 }
 
+void ImageWidget::updateViewport()
+{
+    if (!hasImage())
+        return;
+
+    uint32_t w = m_textureA.width();
+    uint32_t h = m_textureA.height();
+
+    // Image quad spans -1..1 in world space, row 0 is at the top
+    QPointF p0 = widgetToWorld(QPointF(0.f, 0.f));
+    QPointF p1 = widgetToWorld(QPointF(width(), height()));
+    float u0 = std::clamp((std::min(p0.x(), p1.x()) + 1.f) / 2.f, 0.f, 1.f);
+    float u1 = std::clamp((std::max(p0.x(), p1.x()) + 1.f) / 2.f, 0.f, 1.f);
+    float v0 = std::clamp((std::min(p0.y(), p1.y()) + 1.f) / 2.f, 0.f, 1.f);
+    float v1 = std::clamp((std::max(p0.y(), p1.y()) + 1.f) / 2.f, 0.f, 1.f);
+
+    RectU roi;
+    roi.x = std::floor(u0 * w);
+    roi.y = std::floor(v0 * h);
+    roi.width = std::ceil(u1 * w) - roi.x;
+    roi.height = std::ceil(v1 * h) - roi.y;
+
+    // Image is out of view
+    if (roi.width == 0 || roi.height == 0)
+        return;
+
+    // Image size on screen in device pixels
+    QPointF c0 = worldToWidget(QPointF(-1.f, -1.f));
+    QPointF c1 = worldToWidget(QPointF(1.f, 1.f));
+    float displayWidth = std::abs(c1.x() - c0.x()) * devicePixelRatio();
+    float displayHeight = std::abs(c1.y() - c0.y()) * devicePixelRatio();
+
+    uint32_t tw = std::ceil(roi.width * displayWidth / w);
+    uint32_t th = std::ceil(roi.height * displayHeight / h);
+
+    EmitEvent<Evt::ViewChange>(roi, std::min(tw, roi.width), std::min(th, roi.height));
+}
+
 void ImageWidget::createTexture(QOpenGLTexture &tex, const Image &img)
 {
-    QOpenGLTexture::TextureFormat textureFormat = QOpenGLTexture::RGBA32F;
+    QOpenGLTexture::TextureFormat textureFormat;
     QOpenGLTexture::PixelType pixelType;
     QOpenGLTexture::PixelFormat pixelFormat;
     std::array<QOpenGLTexture::SwizzleValue, 4> sw;
-    if (!guessPixelsParameters(img, pixelType, pixelFormat, sw))
+    if (!guessPixelsParameters(img, textureFormat, pixelType, pixelFormat, sw))
         return;
 
     tex.destroy();
@@ -248,7 +322,8 @@ void ImageWidget::createTexture(QOpenGLTexture &tex, const Image &img)
     }
 }
 
-bool ImageWidget::guessPixelsParameters(const Image &img, QOpenGLTexture::PixelType &pt,
+bool ImageWidget::guessPixelsParameters(const Image &img, QOpenGLTexture::TextureFormat &tf,
+                                        QOpenGLTexture::PixelType &pt,
                                         QOpenGLTexture::PixelFormat &pf,
                                         std::array<QOpenGLTexture::SwizzleValue, 4> &sw)
 {
@@ -256,12 +331,17 @@ bool ImageWidget::guessPixelsParameters(const Image &img, QOpenGLTexture::PixelT
         qWarning() << "Could not load image !\n";
         return false;
     }
-    else if (img.type() != PixelType::Float) {
-        qWarning() << "Image pixel type not supported (must be Float) !\n";
+    else if (img.cached()) {
+        qWarning() << "Out-of-core image cannot be displayed directly !\n";
+        return false;
+    }
+    else if (img.type() != PixelType::Float && img.type() != PixelType::Half) {
+        qWarning() << "Image pixel type not supported (must be Float or Half) !\n";
         return false;
     }
 
-    pt = QOpenGLTexture::Float32;
+    bool half = img.type() == PixelType::Half;
+    pt = half ? QOpenGLTexture::Float16 : QOpenGLTexture::Float32;
     sw = {{QOpenGLTexture::RedValue, QOpenGLTexture::GreenValue, QOpenGLTexture::BlueValue,
           QOpenGLTexture::AlphaValue}};
 
@@ -269,14 +349,17 @@ bool ImageWidget::guessPixelsParameters(const Image &img, QOpenGLTexture::PixelT
         case PixelFormat::GRAY: {
             sw[0] = sw[1] = sw[2] = QOpenGLTexture::RedValue;
             pf                    = QOpenGLTexture::Red;
+            tf                    = half ? QOpenGLTexture::R16F : QOpenGLTexture::R32F;
             break;
         }
         case PixelFormat::RGB: {
             pf = QOpenGLTexture::RGB;
+            tf = half ? QOpenGLTexture::RGB16F : QOpenGLTexture::RGB32F;
             break;
         }
         case PixelFormat::RGBA: {
             pf = QOpenGLTexture::RGBA;
+            tf = half ? QOpenGLTexture::RGBA16F : QOpenGLTexture::RGBA32F;
             break;
         }
         default: {
@@ -2,6 +2,8 @@
 
 #include <array>
 
+#include <QtCore/QTimer>
+
 #include "textureview.h"
 #include <utils/event_source.h>
 #include <core/types.h>
@@ -11,12 +13,15 @@ class Image;
 
 typedef EventDesc <
     FuncT<void(QOpenGLTexture &tex)>,
-    FuncT<void(const Image &img)>> IWEvtDesc;
+    FuncT<void(const Image &img)>,
+    FuncT<void(const RectU &roi, uint32_t width, uint32_t height)>> IWEvtDesc;
 
 class ImageWidget : public TextureView, public EventSource<IWEvtDesc>
 {
   public:
-    enum Evt { Update = 0, DropImage };
+    // <ViewChange> gives the visible region of the image (in pixels) and the
+    // resolution it is displayed at, emitted once the view settles.
+    enum Evt { Update = 0, DropImage, ViewChange };
 
   public:
     ImageWidget(QWidget *parent = nullptr);
@@ -34,15 +39,17 @@ class ImageWidget : public TextureView, public EventSource<IWEvtDesc>
   public:
     bool hasImage() const;
     void resetImage(const Image &img);
-    void updateImage(SideBySide sbs, const Image &img);
+    void updateImage(SideBySide sbs, const Image &img, Quality quality = Quality::Full);
 
     GLint texture();
 
   private:
+    void updateViewport();
 
     void createTexture(QOpenGLTexture &tex, const Image &img);
     bool guessPixelsParameters(
             const Image &img,
+            QOpenGLTexture::TextureFormat &tf,
             QOpenGLTexture::PixelType & pt,
             QOpenGLTexture::PixelFormat &pf,
             std::array<QOpenGLTexture::SwizzleValue, 4> &sw);
@@ -58,4 +65,8 @@ class ImageWidget : public TextureView, public EventSource<IWEvtDesc>
     QOpenGLTexture m_textureB;
 
     float m_sliderPosition;
+    Quality m_quality = Quality::Full;
+
+    QMatrix4x4 m_lastViewMatrix;
+    QTimer m_viewTimer;
 };
@@ -4,10 +4,12 @@
 
 #include <version.h>
 #include <context.h>
+#include <core/lutio.h>
 #include <gui/common/setting.h>
 #include <gui/view/dev/widget.h>
 #include <gui/view/look/widget.h>
 #include <gui/view/log/widget.h>
+#include <utils/trace.h>
 
 
 MainWindow::MainWindow(QWidget *parent)
@@ -79,9 +81,13 @@ void MainWindow::setup()
     //
 
     QAction *exportAction = new QAction(QIcon(QPixmap(":/icons/hexa.png")), tr("Export"));
+    QAction *renderAction = new QAction(tr("Render Images..."));
+    QAction *traceAction = new QAction(tr("Export Trace..."));
 
     m_fileMenu = menuBar()->addMenu(tr("&File"));
     m_fileMenu->addAction(exportAction);
+    m_fileMenu->addAction(renderAction);
+    m_fileMenu->addAction(traceAction);
 
     //
     // Connections
@@ -90,8 +96,30 @@ void MainWindow::setup()
     QObject::connect(
         exportAction, &QAction::triggered,
         [this]() {
-            QString fileName = QFileDialog::getSaveFileName(this, tr("Save 3DLUT"), "", tr("Cube Files (*.cube)"));
-            Context::getInstance().pipeline().ExportLUT(fileName.toStdString(), 64);
+            QStringList filters;
+            for (auto ext : LUTFormatExtensions())
+                filters << "*." + QString::fromStdString(ext);
+
+            QString fileName = QFileDialog::getSaveFileName(
+                this, tr("Save 3DLUT"), "", tr("LUT Files (%1)").arg(filters.join(" ")));
+            if (fileName.isEmpty())
+                return;
+
+            bool ok = false;
+            int size = QInputDialog::getInt(this, tr("Save 3DLUT"), tr("LUT Size"), 65, 2, 129, 1, &ok);
+            if (ok)
+                Context::getInstance().pipeline().ExportLUT(fileName.toStdString(), size);
+        }
+    );
+
+    QObject::connect(renderAction, &QAction::triggered, this, &MainWindow::renderImages);
+
+    QObject::connect(
+        traceAction, &QAction::triggered,
+        [this]() {
+            QString fileName = QFileDialog::getSaveFileName(this, tr("Save Trace"), "", tr("Chrome Trace (*.json)"));
+            if (!fileName.isEmpty())
+                Trace::ExportChrome(fileName.toStdString());
         }
     );
 }
@@ -105,6 +133,41 @@ void MainWindow::centerOnScreen()
     move(x, y);
 }
 
+void MainWindow::renderImages()
+{
+    QStringList filters;
+    for (auto ext : Image::SupportedExtensions())
+        filters << "*." + QString::fromStdString(ext);
+
+    QStringList files = QFileDialog::getOpenFileNames(
+        this, tr("Render Images"), "", tr("Images (%1)").arg(filters.join(" ")));
+    if (files.isEmpty())
+        return;
+
+    QString folder = QFileDialog::getExistingDirectory(this, tr("Output Folder"));
+    if (folder.isEmpty())
+        return;
+
+    QProgressDialog progress(tr("Rendering images..."), tr("Cancel"), 0, files.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+
+    ImagePipeline &pipeline = Context::getInstance().pipeline();
+    for (int i = 0; i < files.size() && !progress.wasCanceled(); ++i) {
+        progress.setValue(i);
+
+        QFileInfo info(files[i]);
+        QString dst = QDir(folder).filePath(info.fileName());
+        if (QFileInfo(dst) == info)
+            dst = QDir(folder).filePath(info.completeBaseName() + "_render." + info.suffix());
+
+        PixelType type = info.suffix().toLower() == "exr" ? PixelType::Half : PixelType::Uint16;
+        if (!pipeline.Render(files[i].toStdString(), dst.toStdString(), type))
+            qWarning() << "Could not render" << files[i];
+    }
+
+    progress.setValue(files.size());
+}
+
 void MainWindow::setupHelp()
 {
     QString html;
@@ -25,6 +25,7 @@ class MainWindow : public QMainWindow
 
   private:
     void setupHelp();
+    void renderImages();
 
   private:
     QMenu *m_fileMenu;
@@ -1,5 +1,8 @@
 #include "neutral.h"
 
+#include <cmath>
+#include <limits>
+
 #include <QtWidgets/QGraphicsScene>
 #include <QtWidgets/QOpenGLWidget>
 #include <QtWidgets/QtWidgets>
@@ -13,6 +16,10 @@ uint16_t grid_height = 400;
 
 uint16_t legend_v_spacing = 35;
 
+// Maximum distance (in screen pixels) allowed between a simplified curve and
+// the exact ramp samples.
+float lod_tolerance = 0.5f;
+
 QColor backgroundColor = QColor(200, 200, 200);
 QColor gridSmallColor = QColor(140, 140, 140);
 QColor gridLargeColor = QColor(100, 100, 100);
@@ -30,6 +37,56 @@ QColor lineBColorB = QColor(75, 75, 200);
 QColor colors_a[3] = { lineRColorA, lineGColorA, lineBColorA };
 QColor colors_b[3] = { lineRColorB, lineGColorB, lineBColorB };
 
+// Douglas-Peucker polyline simplification, only keep the samples required for
+// the curve to stay within epsilon of the original ones.
+static std::vector<QPointF> simplifyCurve(const std::vector<QPointF> &pts, float epsilon)
+{
+    if (pts.size() < 3)
+        return pts;
+
+    std::vector<bool> keep(pts.size(), false);
+    keep.front() = true;
+    keep.back() = true;
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.emplace_back(0, pts.size() - 1);
+
+    while (!ranges.empty()) {
+        auto [first, last] = ranges.back();
+        ranges.pop_back();
+
+        QPointF ab = pts[last] - pts[first];
+        float length = std::hypot(ab.x(), ab.y());
+
+        float maxDist = 0.f;
+        size_t index = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            QPointF ap = pts[i] - pts[first];
+            float dist = length > 0.f
+                ? std::abs(ab.x() * ap.y() - ab.y() * ap.x()) / length
+                : std::hypot(ap.x(), ap.y());
+
+            if (dist > maxDist) {
+                maxDist = dist;
+                index = i;
+            }
+        }
+
+        if (maxDist > epsilon) {
+            keep[index] = true;
+            ranges.emplace_back(first, index);
+            ranges.emplace_back(index, last);
+        }
+    }
+
+    std::vector<QPointF> res;
+    for (size_t i = 0; i < pts.size(); ++i)
+        if (keep[i])
+            res.push_back(pts[i]);
+
+    return res;
+}
+
 NeutralWidget::NeutralWidget(QWidget *parent)
 : QGraphicsView(parent)
 {
@@ -48,6 +105,9 @@ NeutralWidget::NeutralWidget(QWidget *parent)
 void NeutralWidget::resizeEvent(QResizeEvent *event)
 {
     fitInView(m_scene->itemsBoundingRect(), Qt::KeepAspectRatio);
+
+    for (auto &[id, items] : m_curves)
+        updateCurveLOD(items);
 }
 
 void NeutralWidget::mouseMoveEvent(QMouseEvent *event)
@@ -77,21 +137,28 @@ void NeutralWidget::clearView()
 
 void NeutralWidget::drawCurve(uint8_t id, const Image &img, const QString &path)
 {
-    CurveItems curveItems;
     QFileInfo fi(path);
     QString fileName = fi.fileName();
     if (auto c = m_curves.find(id); c == m_curves.end()) {
         m_curves[id] = initCurve(id, fileName, img);
-        m_curves[id];
-        curveItems = m_curves[id];
     }
     else {
         m_curves[id].image = img;
         m_curves[id].name = fileName;
-        curveItems = m_curves[id];
     }
+
+    // Image changed, previously simplified paths are now invalid
+    CurveItems &curveItems = m_curves[id];
+    for (uint8_t c = 0; c < 3; ++c)
+        curveItems.lodPaths[c].clear();
+    curveItems.lodLevel = std::numeric_limits<int>::min();
+
     drawCurve(curveItems, id);
     fitInView(m_scene->itemsBoundingRect(), Qt::KeepAspectRatio);
+
+    // Fitting the view may have changed the zoom level
+    for (auto &[k, items] : m_curves)
+        updateCurveLOD(items);
 }
 
 void NeutralWidget::clearCurve(uint8_t id)
@@ -148,6 +215,8 @@ CurveItems NeutralWidget::initCurve(uint8_t id, QString path, const Image &img)
     for (uint8_t i = 0; i < 3; ++i) {
         pen.setColor(id == 1 ? colors_b[i] : colors_a[i]);
         items.curve[i] = m_scene->addPath(QPainterPath(), pen);
+        // Cursor scrubbing only repaints the cursor items, curves are blitted
+        items.curve[i]->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
         items.cursorHLine[i] = m_scene->addLine(QLineF(), pen);
     }
 
@@ -161,6 +230,7 @@ CurveItems NeutralWidget::initCurve(uint8_t id, QString path, const Image &img)
 
     items.name = path;
     items.image = img;
+    items.lodLevel = std::numeric_limits<int>::min();
 
     return items;
 }
@@ -195,23 +265,10 @@ void NeutralWidget::drawGrid()
     m_scene->addLine(0.0, grid_height, grid_width, 0.0, pen);
 }
 
-void NeutralWidget::drawCurve(const CurveItems &items, uint8_t id)
+void NeutralWidget::drawCurve(CurveItems &items, uint8_t id)
 {
     // Draw R,G,B curves
-    const float * pix = items.image.pixels_asfloat();
-    for (uint8_t c = 0; c < 3; ++c) {
-        QPainterPath path;
-        path.moveTo(0, grid_height - (grid_height * pix[c]));
-
-        for (uint32_t i = 0; i < items.image.width(); ++i) {
-            path.lineTo(
-                (1.0 * i / items.image.width()) * grid_width,
-                grid_height - (grid_height * pix[i * 3 + c])
-            );
-        }
-
-        items.curve[c]->setPath(path);
-    }
+    updateCurveLOD(items);
 
     // Draw legends
     uint16_t xmid = grid_width - (grid_width / 2);
@@ -223,6 +280,56 @@ void NeutralWidget::drawCurve(const CurveItems &items, uint8_t id)
         items.curveLegend->setLine(xmid - 35, ypos + 12, xmid - 10, ypos + 12);
 }
 
+void NeutralWidget::updateCurveLOD(CurveItems &items)
+{
+    int level = zoomLevel();
+    if (level == items.lodLevel)
+        return;
+
+    // Tolerance is given in screen pixels, convert it to scene units
+    float epsilon = lod_tolerance / std::exp2(0.5f * level);
+
+    const float * pix = items.image.pixels_asfloat();
+    for (uint8_t c = 0; c < 3; ++c) {
+        auto it = items.lodPaths[c].find(level);
+        if (it == items.lodPaths[c].end()) {
+            std::vector<QPointF> pts;
+            pts.reserve(items.image.width() + 1);
+            pts.emplace_back(0, grid_height - (grid_height * pix[c]));
+
+            for (uint32_t i = 0; i < items.image.width(); ++i) {
+                pts.emplace_back(
+                    (1.0 * i / items.image.width()) * grid_width,
+                    grid_height - (grid_height * pix[i * 3 + c])
+                );
+            }
+
+            pts = simplifyCurve(pts, epsilon);
+
+            QPainterPath path;
+            path.moveTo(pts[0]);
+            for (size_t i = 1; i < pts.size(); ++i)
+                path.lineTo(pts[i]);
+
+            it = items.lodPaths[c].emplace(level, path).first;
+        }
+
+        items.curve[c]->setPath(it->second);
+    }
+
+    items.lodLevel = level;
+}
+
+int NeutralWidget::zoomLevel() const
+{
+    // Half octave steps of the view scale
+    float scale = transform().m22();
+    if (scale <= 0.f)
+        return 0;
+
+    return std::lround(2.f * std::log2(scale));
+}
+
 void NeutralWidget::drawCursor(uint16_t x, uint16_t y)
 {
     QPointF scenePos = mapToScene(x, y);
@@ -236,7 +343,7 @@ void NeutralWidget::drawCursor(uint16_t x, uint16_t y)
     uint8_t count = 0;
     for (auto& [id, items] : m_curves) {
 
-        uint16_t inXInt = std::clamp((int) (inX * items.image.width()), 0, items.image.width() - 1);
+        uint16_t inXInt = std::clamp((int) (inX * items.image.width()), 0, (int) items.image.width() - 1);
         const float * pix = items.image.pixels_asfloat();
 
         float out[3];
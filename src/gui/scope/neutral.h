@@ -4,6 +4,7 @@
 #include <map>
 
 #include <QtWidgets/QGraphicsView>
+#include <QtGui/QPainterPath>
 
 #include <utils/generic.h>
 #include <core/image.h>
@@ -19,6 +20,9 @@ class QGraphicsPathItem;
 
 struct CurveItems {
     Image image;
+    // Simplified curve paths, keyed by zoom level
+    std::map<int, QPainterPath> lodPaths[3];
+    int lodLevel;
     QGraphicsPathItem *curve[3];
     QGraphicsTextItem *curveName;
     QGraphicsLineItem *curveLegend;
@@ -49,7 +53,9 @@ class NeutralWidget : public QGraphicsView
     CurveItems initCurve(uint8_t id, QString path, const Image &img);
 
     void drawGrid();
-    void drawCurve(const CurveItems &items, uint8_t id);
+    void drawCurve(CurveItems &items, uint8_t id);
+    void updateCurveLOD(CurveItems &items);
+    int zoomLevel() const;
     void drawCursor(uint16_t x, uint16_t y);
     void hideCursors();
     void showCursors();
@@ -1,5 +1,7 @@
 #include "pipeline.h"
 
+#include <algorithm>
+
 #include <QtCore/QDebug>
 #include <QtCore/QMimeData>
 #include <QtGui/QDragEnterEvent>
@@ -7,6 +9,7 @@
 
 #include <context.h>
 #include <gui/common/imageviewer.h>
+#include <operator/lut/frozen.h>
 #include "widget.h"
 #include "operator.h"
 
@@ -14,7 +17,7 @@
 PipelineWidget::PipelineWidget(QWidget *parent)
     : QListWidget(parent)
 {
-    setSelectionMode(QAbstractItemView::SingleSelection);
+    setSelectionMode(QAbstractItemView::ContiguousSelection);
     setDragEnabled(true);
     setDragDropMode(QAbstractItemView::InternalMove);
     setDefaultDropAction(Qt::MoveAction);
@@ -28,10 +31,13 @@ void PipelineWidget::keyPressEvent(QKeyEvent *event)
     if (currentRow() >= 0) {
         switch (event->key()) {
             case Qt::Key_D:
-                disableSelection(currentRow());
+                disableSelection();
                 break;
             case Qt::Key_Backspace:
-                removeSelection(currentRow());
+                removeSelection();
+                break;
+            case Qt::Key_F:
+                freezeSelection();
                 break;
             default:
                 QListWidget::keyPressEvent(event);
@@ -92,12 +98,21 @@ void PipelineWidget::addFromName(const std::string &name)
 }
 
 void PipelineWidget::addOperator(ImageOperator &op)
+{
+    m_pipeline->AddOperator(&op);
+    insertOperatorItem(count(), op);
+
+    setCurrentRow(count() - 1);
+    updateSelection(currentItem());
+}
+
+void PipelineWidget::insertOperatorItem(int row, ImageOperator &op)
 {
     QListWidgetItem *item = new QListWidgetItem(QString::fromStdString(op.OpLabel()));
     item->setToolTip(QString::fromStdString(op.OpDesc()));
-    addItem(item);
+    insertItem(row, item);
 
-    op.Subscribe<ImageOperator::Update>([item, &op](){
+    m_connections[&op] = op.Subscribe<ImageOperator::Update>([item, &op](){
         bool enabled = op.GetParameter<CheckBoxParameter>("Enabled")->value();
         QColor color = enabled ? QColor("#d7d6d5") : QColor("gray");
 
@@ -106,11 +121,23 @@ void PipelineWidget::addOperator(ImageOperator &op)
         item->setForeground(QBrush(color));
     });
 
-    m_pipeline->AddOperator(&op);
-    m_devWidget->operatorWidget()->insertWidget(count() - 1, new OperatorWidget(&op));
+    m_devWidget->operatorWidget()->insertWidget(row, new OperatorWidget(&op));
+}
 
-    setCurrentRow(count() - 1);
-    updateSelection(currentItem());
+void PipelineWidget::removeOperatorItem(int row)
+{
+    // Operators may outlive their item when frozen
+    ImageOperator &op = m_pipeline->GetOperator(row);
+    auto it = m_connections.find(&op);
+    if (it != m_connections.end()) {
+        op.Unsubscribe<ImageOperator::Update>(it->second);
+        m_connections.erase(it);
+    }
+
+    delete takeItem(row);
+    QWidget *widget = m_devWidget->operatorWidget()->widget(row);
+    m_devWidget->operatorWidget()->removeWidget(widget);
+    delete widget;
 }
 
 void PipelineWidget::updateSelection(QListWidgetItem *item)
@@ -127,24 +154,76 @@ void PipelineWidget::updateSelection(QListWidgetItem *item)
     m_devWidget->operatorWidget()->setCurrentIndex(selectedRow);
 }
 
-void PipelineWidget::disableSelection(int selectedRow)
+std::vector<int> PipelineWidget::selectedOperatorRows() const
+{
+    // Selected rows in increasing order, the current row when nothing is
+    // selected
+    std::vector<int> rows;
+    for (auto & index : selectionModel()->selectedRows())
+        if (index.row() < m_pipeline->OperatorCount())
+            rows.push_back(index.row());
+
+    if (rows.empty() && currentRow() >= 0 && currentRow() < m_pipeline->OperatorCount())
+        rows.push_back(currentRow());
+
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+void PipelineWidget::disableSelection()
 {
     // NOTE : we should also track the operator state to choose new styles on enable /
     // disable From the CSS would be perfect, I think we have to subclass QListWidgetItem
     // and add new property that will be accessible from the CSS ?
-    auto &op =m_pipeline->GetOperator(selectedRow);
-    auto param  = op.GetParameter<CheckBoxParameter>("Enabled");
-    param->setValue(!param->value());
+    PipelineUpdate update(*m_pipeline);
+    for (int row : selectedOperatorRows()) {
+        auto &op = m_pipeline->GetOperator(row);
+        auto param  = op.GetParameter<CheckBoxParameter>("Enabled");
+        param->setValue(!param->value());
+    }
 }
 
-void PipelineWidget::removeSelection(int selectedRow)
+void PipelineWidget::removeSelection()
 {
-    if (selectedRow <=m_pipeline->OperatorCount()) {
-        takeItem(selectedRow);
-        QWidget *widget = m_devWidget->operatorWidget()->widget(selectedRow);
-        m_devWidget->operatorWidget()->removeWidget(widget);
-        delete widget;
+    std::vector<int> rows = selectedOperatorRows();
+    if (rows.empty())
+        return;
 
-       m_pipeline->DeleteOperator(selectedRow);
+    PipelineUpdate update(*m_pipeline);
+    for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
+        removeOperatorItem(*it);
+        m_pipeline->DeleteOperator(*it);
     }
-}
\ No newline at end of file
+}
+
+void PipelineWidget::freezeSelection()
+{
+    std::vector<int> rows = selectedOperatorRows();
+    if (rows.empty())
+        return;
+
+    int first = rows.front();
+    int last = rows.back();
+
+    // A single frozen operator is unfrozen, other selections are frozen
+    ImageOperator &op = m_pipeline->GetOperator(first);
+    if (first == last && dynamic_cast<FrozenOperator *>(&op)) {
+        int before = m_pipeline->OperatorCount();
+        removeOperatorItem(first);
+        m_pipeline->UnfreezeOperator(first);
+
+        int restored = m_pipeline->OperatorCount() - before + 1;
+        for (int i = 0; i < restored; ++i)
+            insertOperatorItem(first + i, m_pipeline->GetOperator(first + i));
+    }
+    else {
+        for (int row = last; row >= first; --row)
+            removeOperatorItem(row);
+
+        if (ImageOperator *frozen = m_pipeline->FreezeOperators(first, last))
+            insertOperatorItem(first, *frozen);
+    }
+
+    setCurrentRow(first);
+    updateSelection(currentItem());
+}
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <map>
+#include <vector>
+
 #include <QtWidgets/QListWidget>
 
+#include <utils/event_source.h>
+
 
 class DevWidget;
 class ImagePipeline;
@@ -32,12 +37,17 @@ class PipelineWidget : public QListWidget
 
   private:
     void addOperator(ImageOperator &op);
+    void insertOperatorItem(int row, ImageOperator &op);
+    void removeOperatorItem(int row);
 
     void updateSelection(QListWidgetItem * item);
-    void disableSelection(int selectedRow);
-    void removeSelection(int selectedRow);
+    std::vector<int> selectedOperatorRows() const;
+    void disableSelection();
+    void removeSelection();
+    void freezeSelection();
 
   private:
     ImagePipeline *m_pipeline = nullptr;
     DevWidget *m_devWidget = nullptr;
+    std::map<ImageOperator *, EventProxy> m_connections;
 };
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "timing.h"
+
+#include <algorithm>
+
+#include <QtWidgets/QtWidgets>
+
+#include <utils/trace.h>
+
+
+TimingWidget::TimingWidget(QWidget *parent)
+    : QTableWidget(parent)
+{
+    setColumnCount(5);
+    setHorizontalHeaderLabels({ "Operator", "Count", "p50 (msec)", "p95 (msec)", "Total (msec)" });
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setSelectionMode(QAbstractItemView::NoSelection);
+    setSortingEnabled(false);
+    verticalHeader()->setVisible(false);
+    horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+}
+
+void TimingWidget::updateTimings()
+{
+    // Main pipeline only, spans are named "<pipeline>/<stage> <operator>"
+    // and look thumbnails or renders would be pooled with the preview
+    const std::string prefix = "main/";
+    std::vector<Trace::Stat> stats = Trace::Stats("operator");
+    stats.erase(std::remove_if(stats.begin(), stats.end(), [&prefix](const auto &s) {
+        return s.name.compare(0, prefix.size(), prefix) != 0;
+    }), stats.end());
+
+    // Slowest operators first
+    std::sort(stats.begin(), stats.end(), [](const auto &a, const auto &b) {
+        return a.total > b.total;
+    });
+
+    auto number = [](float v) {
+        QTableWidgetItem *item = new QTableWidgetItem(QString::number(v, 'f', 2));
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        return item;
+    };
+
+    setRowCount(stats.size());
+    for (int i = 0; i < int(stats.size()); ++i) {
+        const Trace::Stat &s = stats[i];
+        setItem(i, 0, new QTableWidgetItem(QString::fromStdString(s.name.substr(prefix.size()))));
+
+        QTableWidgetItem *count = new QTableWidgetItem(QString::number(s.count));
+        count->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        setItem(i, 1, count);
+        setItem(i, 2, number(s.p50));
+        setItem(i, 3, number(s.p95));
+        setItem(i, 4, number(s.total));
+    }
+}
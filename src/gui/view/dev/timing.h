@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtWidgets/QTableWidget>
+
+
+// Per operator timing summary, gathered from the "operator" trace spans
+class TimingWidget : public QTableWidget
+{
+  public:
+    TimingWidget(QWidget *parent = nullptr);
+
+  public:
+    void updateTimings();
+};
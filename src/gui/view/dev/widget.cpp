@@ -14,9 +14,11 @@
 #include <gui/scope/neutral.h>
 #include <gui/scope/cube.h>
 #include <gui/scope/vectorscope.h>
+#include <utils/trace.h>
 #include "pipeline.h"
 #include "operator.h"
 #include "operatorlist.h"
+#include "timing.h"
 
 
 DevWidget::DevWidget(QWidget *parent)
@@ -51,6 +53,7 @@ DevWidget::DevWidget(QWidget *parent)
     m_neutralsWidget = new NeutralWidget();
     m_cubeWidget = new CubeWidget();
     m_vectorscopeWidget = new VectorScopeWidget();
+    m_timingWidget = new TimingWidget();
 
     // NOTE : see https://stackoverflow.com/a/43835396/4814046
     QSplitter *vSplitter = findChild<QSplitter*>("vSplitter");
@@ -70,6 +73,8 @@ DevWidget::DevWidget(QWidget *parent)
     //
 
     using std::placeholders::_1;
+    using std::placeholders::_2;
+    using std::placeholders::_3;
     using IP = ImagePipeline;
     using IW = ImageWidget;
     using BW = BrowserWidget;
@@ -79,10 +84,11 @@ DevWidget::DevWidget(QWidget *parent)
     ParameterSerialList& settings = Context::getInstance().settings();
 
     pipeline.Subscribe<IP::NewInput>(std::bind(&ImageWidget::resetImage, m_imageWidget, _1));
-    pipeline.Subscribe<IP::Update>(std::bind(&ImageWidget::updateImage, m_imageWidget, SideBySide::A, _1));
-    pipeline.Subscribe<IP::Update>(std::bind(&DevWidget::updateScope, this, _1));
+    pipeline.Subscribe<IP::Update>(std::bind(&ImageWidget::updateImage, m_imageWidget, SideBySide::A, _1, _2));
+    pipeline.Subscribe<IP::Update>(std::bind(&DevWidget::updateScope, this, _1, _2));
 
     m_imageWidget->Subscribe<IW::DropImage>(std::bind(&ImagePipeline::SetInput, &pipeline, _1));
+    m_imageWidget->Subscribe<IW::ViewChange>(std::bind(&ImagePipeline::SetRegionOfInterest, &pipeline, _1, _2, _3));
 
     auto lookRootPath = settings.Get<FilePathParameter>("Look Base Folder");
     lookRootPath->Subscribe<P::UpdateValue>([this](auto &p){
@@ -160,6 +166,7 @@ void DevWidget::setupScopeView()
     m_scopeStack->addWidget(m_neutralsWidget);
     m_scopeStack->addWidget(m_cubeWidget);
     m_scopeStack->addWidget(m_vectorscopeWidget);
+    m_scopeStack->addWidget(m_timingWidget);
     m_scopeStack->setCurrentWidget(m_waveformWidget);
 
     // NOTE : ideally we should make no assumptions of what scope mode are
@@ -170,6 +177,7 @@ void DevWidget::setupScopeView()
     m_scopeTab->addTab("N");
     m_scopeTab->addTab("C");
     m_scopeTab->addTab("V");
+    m_scopeTab->addTab("T");
 
     QObject::connect(
         m_scopeTab, &QTabBar::tabBarClicked,
@@ -193,6 +201,9 @@ void DevWidget::setupScopeView()
             else if (tabText == "V") {
                 m_scopeStack->setCurrentWidget(m_vectorscopeWidget);
             }
+            else if (tabText == "T") {
+                m_scopeStack->setCurrentWidget(m_timingWidget);
+            }
 
             // Need to manually update the scope because it's not updated when not visible.
             updateScope(Context::getInstance().pipeline().GetOutput());
@@ -205,20 +216,37 @@ void DevWidget::setupOperatorsView()
     m_operatorsWidget->setDevWidget(this);
 }
 
-void DevWidget::updateScope(const Image &img)
+void DevWidget::updateScope(const Image &img, Quality quality)
 {
     ImagePipeline& pipeline = Context::getInstance().pipeline();
 
+    // Transformation scopes do not depend on the image, a full quality
+    // update always follows a proxy one so they are only computed once.
+    bool transformScope = m_scopeStack->currentWidget() == m_neutralsWidget ||
+                          m_scopeStack->currentWidget() == m_cubeWidget;
+    if (transformScope && quality == Quality::Proxy)
+        return;
+
+    // Timings are only meaningful once the full quality image is computed
+    if (m_scopeStack->currentWidget() == m_timingWidget) {
+        if (quality == Quality::Full)
+            m_timingWidget->updateTimings();
+        return;
+    }
+
+    int tab = m_scopeTab->currentIndex();
+    TraceScope trace("scope", "Scope " + m_scopeTab->tabText(tab).toStdString());
+
     if (m_scopeStack->currentWidget() == m_neutralsWidget) {
         qInfo() << "Compute Ramp (curve scope)";
         *m_imageCompute = *m_imageRamp;
-        pipeline.ComputeImage(*m_imageCompute);
+        pipeline.ComputeImage(*m_imageCompute, "scope");
         m_neutralsWidget->drawCurve(0, *m_imageCompute);
     }
     else if (m_scopeStack->currentWidget() == m_cubeWidget) {
         qInfo() << "Compute Lattice (cube scope)";
         *m_imageCompute = *m_imageLattice;
-        pipeline.ComputeImage(*m_imageCompute);
+        pipeline.ComputeImage(*m_imageCompute, "scope");
         m_cubeWidget->drawCube(*m_imageCompute);
     }
     else if (m_scopeStack->currentWidget() == m_waveformWidget) {
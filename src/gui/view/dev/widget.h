@@ -3,6 +3,7 @@
 #include <QtWidgets/QWidget>
 
 #include <utils/generic.h>
+#include <core/types.h>
 
 
 class Image;
@@ -16,6 +17,7 @@ class BrowserWidget;
 class QTabBar;
 class QStackedWidget;
 class VectorScopeWidget;
+class TimingWidget;
 
 class DevWidget : public QWidget
 {
@@ -36,7 +38,7 @@ class DevWidget : public QWidget
     void setupScopeView();
     QWidget * setupUi();
 
-    void updateScope(const Image &img);
+    void updateScope(const Image &img, Quality quality = Quality::Full);
 
   private:
     ImageWidget *m_imageWidget;
@@ -50,6 +52,7 @@ class DevWidget : public QWidget
     VectorScopeWidget *m_vectorscopeWidget;
     NeutralWidget *m_neutralsWidget;
     CubeWidget *m_cubeWidget;
+    TimingWidget *m_timingWidget;
 
     BrowserWidget *m_lookBrowser;
     BrowserWidget *m_imageBrowser;
@@ -198,7 +198,7 @@ QImage LookViewWidget::computeThumbnail(const QString &path)
         res = QImage(
             img.pixels(), img.width(), img.height(),
             img.width() * img.channels() * 1,
-            QImage::Format_RGBA8888);
+            img.channels() == 3 ? QImage::Format_RGB888 : QImage::Format_RGBA8888);
     }
     else {
         res = QImage(
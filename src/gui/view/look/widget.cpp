@@ -6,6 +6,7 @@
 #include <context.h>
 #include <core/types.h>
 #include <core/image.h>
+#include <core/imagepyramid.h>
 #include <operator/ocio/filetransform.h>
 #include <gui/mainwindow.h>
 #include <gui/uiloader.h>
@@ -35,6 +36,7 @@ LookWidget::LookWidget(QWidget *parent)
 {
     m_pipeline = std::make_unique<ImagePipeline>();
     m_pipeline->SetName("look");
+    m_pipeline->SetResultCache(&Context::getInstance().resultCache());
     m_imageRamp = std::make_unique<Image>(Image::Ramp1D(4096));
     m_imageLattice = std::make_unique<Image>(Image::Lattice(17));
 
@@ -101,7 +103,9 @@ LookWidget::LookWidget(QWidget *parent)
 
     m_lookBrowser->Subscribe<BW::Select>(std::bind(&LV::showFolder, m_viewTabWidget, _1));
     m_imageBrowser->Subscribe<BW::Select>([this](const QString &path) {
-        updateImage(Image::FromFile(path.toStdString()));
+        // Looks are previewed fitted on screen, no need to decode further
+        QSize size = QGuiApplication::primaryScreen()->size() * devicePixelRatio();
+        updateImage(Image::FromFile(path.toStdString(), size.width(), size.height()));
         resetViews();
         updateViews();
     });
@@ -209,15 +213,21 @@ TupleT<bool, Image &> LookWidget::lookPreviewLattice(const QString &lookPath)
 
 TupleT<bool, Image &> LookWidget::lookPreview(const QString &lookPath, Image &img)
 {
-    ImageOperator &op = m_pipeline->GetOperator(0);
-    auto opPath = op.GetParameter<FilePathParameter>("LUT");
-    std::string currentPath = opPath->value();
-    std::string requestPath = lookPath.toStdString();
+    {
+        // Look and input changes are computed once
+        PipelineUpdate update(*m_pipeline);
+
+        ImageOperator &op = m_pipeline->GetOperator(0);
+        auto opPath = op.GetParameter<FilePathParameter>("LUT");
+        std::string currentPath = opPath->value();
+        std::string requestPath = lookPath.toStdString();
 
-    if (currentPath != requestPath)
-        opPath->setValue(requestPath);
+        if (currentPath != requestPath)
+            opPath->setValue(requestPath);
+
+        m_pipeline->SetInput(img);
+    }
 
-    m_pipeline->SetInput(img);
     return { true, m_pipeline->GetOutput() };
 }
 
@@ -233,6 +243,7 @@ void LookWidget::setupPipeline()
 {
     updateImage(Context::getInstance().pipeline().GetInput());
 
+    PipelineUpdate update(*m_pipeline);
     m_pipeline->AddOperator<OCIOFileTransform>();
     m_pipeline->AddOperator<OCIOFileTransform>();
 }
@@ -261,6 +272,14 @@ void LookWidget::setupSetting()
         toggleToneMap(cb.value());
     });
 
+    SelectParameter *s = m_settings->Add<SelectParameter>("LUT Size", std::vector<std::string>{ "Native", "17", "33", "65" }, "Native");
+    updateLUTSize(s->value());
+
+    s->Subscribe<Parameter::UpdateValue>([this](const Parameter &p){
+        const SelectParameter & sp = static_cast<const SelectParameter&>(p);
+        updateLUTSize(sp.value());
+    });
+
     QVBoxLayout *layout = new QVBoxLayout(m_settingWidget);
     layout->setContentsMargins(0, 0, 0, 0);
     SettingWidget *sw = new SettingWidget(m_settings);
@@ -272,10 +291,32 @@ void LookWidget::updateImage(const Image &img)
     if (!img)
         return;
 
-    m_image = std::make_unique<Image>(img);
-    m_imageProxy = std::make_unique<Image>(*m_image);
-    *m_imageProxy = m_imageProxy->resize(
-        m_proxySize.width(), m_proxySize.height(), true, "box");
+    // Same image loaded again, keep the current proxies. The full content
+    // hash is required, a sampled one matches between similar frames
+    // (out-of-core images hash is cheap, based on the file name)
+    uint64_t key = img.hash();
+    if (m_image && key == m_imageKey)
+        return;
+    m_imageKey = key;
+
+    // Out-of-core images are brought in memory at screen resolution
+    if (img.cached()) {
+        QSize size = QGuiApplication::primaryScreen()->size() * devicePixelRatio();
+        ImagePyramid pyramid(img);
+        m_image = std::make_unique<Image>(
+            pyramid.level(pyramid.levelFor(size.width(), size.height())));
+    }
+    else {
+        m_image = std::make_unique<Image>(img);
+    }
+
+    m_imagePyramid = std::make_unique<ImagePyramid>(*m_image);
+
+    // Thumbnails are resized from the closest pyramid level instead of the
+    // full resolution image
+    uint8_t level = m_imagePyramid->levelFor(m_proxySize.width(), m_proxySize.height());
+    m_imageProxy = std::make_unique<Image>(m_imagePyramid->level(level).resize(
+        m_proxySize.width(), m_proxySize.height(), true, "box"));
 }
 
 void LookWidget::resetViews()
@@ -298,6 +339,15 @@ void LookWidget::toggleToneMap(bool v)
     updateViews();
 }
 
+void LookWidget::updateLUTSize(const std::string &v)
+{
+    // Looks are resampled to a common lattice size for uniform previews
+    ImageOperator &op = m_pipeline->GetOperator(0);
+    op.GetParameter<SelectParameter>("Lattice Size")->setValue(v);
+
+    updateViews();
+}
+
 void LookWidget::updateToneMap()
 {
     QString path = QString::fromStdString(
@@ -308,6 +358,7 @@ void LookWidget::updateToneMap()
         return;
 
     if (auto op = Context::getInstance().operators().CreateFromPath(path.toStdString())) {
+        PipelineUpdate update(*m_pipeline);
         op = m_pipeline->ReplaceOperator(op, 1);
         op->GetParameter<CheckBoxParameter>("Enabled")->setValue(tonemapEnabled());
     }
@@ -7,6 +7,7 @@
 
 
 class Image;
+class ImagePyramid;
 class ImagePipeline;
 class BrowserWidget;
 class LookViewTabWidget;
@@ -49,6 +50,7 @@ class LookWidget : public QWidget
     void resetViews();
     void updateViews();
     void toggleToneMap(bool v);
+    void updateLUTSize(const std::string &v);
     void updateToneMap();
 
   private:
@@ -69,7 +71,9 @@ class LookWidget : public QWidget
     QByteArray m_vSplitterState;
 
     UPtr<Image> m_image;
+    uint64_t m_imageKey = 0;
     UPtr<Image> m_imageProxy;
+    UPtr<ImagePyramid> m_imagePyramid;
     UPtr<Image> m_imageRamp;
     UPtr<Image> m_imageLattice;
     UPtr<ImagePipeline> m_pipeline;
@@ -4,6 +4,7 @@
 #include <QtGui/QSurfaceFormat>
 #include <QtWidgets/QDesktopWidget>
 #include <QFile>
+#include <QDir>
 
 #include <context.h>
 #include <gui/mainwindow.h>
@@ -11,6 +12,8 @@
 #include <operator/ocio/filetransform.h>
 #include <operator/ocio/colorspace.h>
 #include <operator/ctl/operator.h>
+#include <core/lutio.h>
+#include <utils/trace.h>
 
 
 void setupContext()
@@ -24,10 +27,48 @@ void setupContext()
     s.Add<FP>("Image Base Folder", "", "Choose a folder", "", FP::PathType::Folder);
     s.Add<FP>("Look Base Folder", "", "Choose a folder", "", FP::PathType::Folder);
     s.Add<FP>("Look Tonemap LUT", "", "Choose a LUT", "");
+    s.Add<CheckBoxParameter>("Progressive Preview", true);
+    s.Add<SliderParameter>("Progressive Refine Delay", 300.f, 0.f, 2000.f, 50.f);
+    s.Add<SelectParameter>("Working Format", std::vector<std::string>{ "RGBA", "RGB" }, "RGBA");
+    s.Add<SliderParameter>("Image Memory Limit (MB)", 4096.f, 256.f, 65536.f, 256.f);
+    s.Add<SliderParameter>("Result Cache (MB)", 512.f, 0.f, 16384.f, 128.f);
+
+    Image::SetMemoryLimit(s.Get<SliderParameter>("Image Memory Limit (MB)")->value());
+    s.Get<SliderParameter>("Image Memory Limit (MB)")->Subscribe<Parameter::UpdateValue>([](auto &param) {
+        Image::SetMemoryLimit(static_cast<const SliderParameter &>(param).value());
+    });
+
+    ResultCache& cache = Context::getInstance().resultCache();
+    cache.setBudget(s.Get<SliderParameter>("Result Cache (MB)")->value());
+    s.Get<SliderParameter>("Result Cache (MB)")->Subscribe<Parameter::UpdateValue>([&cache](auto &param) {
+        cache.setBudget(static_cast<const SliderParameter &>(param).value());
+    });
+
+    auto workingFormat = [](const std::string &v) {
+        Image::SetWorkingFormat(v == "RGB" ? PixelFormat::RGB : PixelFormat::RGBA);
+    };
+    workingFormat(s.Get<SelectParameter>("Working Format")->value());
 
     // Pipeline
     ImagePipeline& p = Context::getInstance().pipeline();
     p.SetName("main");
+    p.SetProgressive(s.Get<CheckBoxParameter>("Progressive Preview")->value());
+    p.SetRefineInterval(s.Get<SliderParameter>("Progressive Refine Delay")->value());
+    p.SetResultCache(&cache);
+
+    s.Get<CheckBoxParameter>("Progressive Preview")->Subscribe<Parameter::UpdateValue>([&p](auto &param) {
+        p.SetProgressive(static_cast<const CheckBoxParameter &>(param).value());
+    });
+    s.Get<SliderParameter>("Progressive Refine Delay")->Subscribe<Parameter::UpdateValue>([&p](auto &param) {
+        p.SetRefineInterval(static_cast<const SliderParameter &>(param).value());
+    });
+    s.Get<SelectParameter>("Working Format")->Subscribe<Parameter::UpdateValue>([&p, workingFormat](auto &param) {
+        workingFormat(static_cast<const SelectParameter &>(param).value());
+
+        // Convert current input, other images are converted on next load
+        Image img = p.GetInput().to_format(Image::WorkingFormat());
+        p.SetInput(img);
+    });
 
     QFile f = QFile(":/images/stresstest.exr");
     QByteArray blob;
@@ -44,6 +85,52 @@ void setupContext()
     o.Register<CTLTransform>();
 }
 
+int resampleLUTs(const QStringList &args)
+{
+    // resample <folder> <size> [<output folder>]
+    QDir input(args[2]);
+    uint32_t size = args[3].toUInt();
+    QDir output(args.size() > 4 ? args[4] : input.filePath("resampled"));
+
+    if (!input.exists() || size < 2 || size > 129 || !output.mkpath(".")) {
+        qWarning() << "Usage : resample <folder> <size (2 to 129)> [<output folder>]\n";
+        return 1;
+    }
+
+    OCIOFileTransform ft;
+    QStringList filters;
+    for (const QString &ext : ft.SupportedExtensions())
+        filters << "*." + ext;
+
+    int failed = 0;
+    for (const QFileInfo &file : input.entryInfoList(filters, QDir::Files, QDir::Name)) {
+        ft.SetFileTransform(file.absoluteFilePath().toStdString());
+
+        const LUT3D &lut = ft.NativeLUT();
+        if (!lut) {
+            qWarning() << "Resample - not a 3D LUT :" << file.fileName() << "\n";
+            ++failed;
+            continue;
+        }
+
+        // Same format when it can be written, .cube otherwise
+        QString name = file.fileName();
+        if (!LUTFormatFromPath(name.toStdString()))
+            name = file.completeBaseName() + ".cube";
+
+        LUT3D res = lut.resample(size);
+        if (!WriteLUT(res, output.filePath(name).toStdString())) {
+            ++failed;
+            continue;
+        }
+
+        qInfo() << "Resample -" << file.fileName() << ":" << lut.size() << "->" << size
+                << "max error" << lut.difference(res) << "\n";
+    }
+
+    return failed ? 1 : 0;
+}
+
 int main(int argc, char **argv)
 {
     QCoreApplication::setApplicationName("Eclair Looks");
@@ -52,6 +139,14 @@ int main(int argc, char **argv)
     QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
     QCoreApplication::setAttribute(Qt::AA_UseDesktopOpenGL);
 
+    // Command line tools, no display needed
+    if (argc > 3 && std::string(argv[1]) == "resample") {
+        QCoreApplication app(argc, argv);
+        QLocale::setDefault(QLocale("C"));
+        setlocale(LC_NUMERIC, "C");
+        return resampleLUTs(app.arguments());
+    }
+
     QSurfaceFormat format;
     format.setSamples(16);
     format.setProfile(QSurfaceFormat::CoreProfile);
@@ -61,14 +156,6 @@ int main(int argc, char **argv)
     format.setDepthBufferSize(24);
     QSurfaceFormat::setDefaultFormat(format);
 
-    setupContext();
-
-    std::string imgPath =
-        Context::getInstance().settings()
-        .Get<FilePathParameter>("Default Image")->value();
-    if(Image img = Image::FromFile(imgPath))
-        Context::getInstance().pipeline().SetInput(img);
-
     QApplication app(argc, argv);
 
     // Make sure we use C locale to parse float
@@ -77,6 +164,27 @@ int main(int argc, char **argv)
     QLocale::setDefault(QLocale("C"));
     setlocale(LC_NUMERIC, "C");
 
+    // Spans recorded during the session are written on exit
+    QString tracePath;
+    QStringList args = app.arguments();
+    int traceArg = args.indexOf("--trace");
+    if (traceArg != -1 && traceArg + 1 < args.size())
+        tracePath = args[traceArg + 1];
+
+    // Pipeline relies on timers for deferred computations, the application
+    // must exist beforehand. Settings restore and image loading are
+    // computed once.
+    {
+        PipelineUpdate update(Context::getInstance().pipeline());
+        setupContext();
+
+        std::string imgPath =
+            Context::getInstance().settings()
+            .Get<FilePathParameter>("Default Image")->value();
+        if(Image img = Image::FromFile(imgPath))
+            Context::getInstance().pipeline().SetInput(img);
+    }
+
     QFile cssFile(":/css/application.css");
     cssFile.open(QFile::ReadOnly);
     QString cssString = QLatin1String(cssFile.readAll());
@@ -89,5 +197,10 @@ int main(int argc, char **argv)
 
     Context::getInstance().pipeline().Init();
 
-    return app.exec();
+    int res = app.exec();
+
+    if (!tracePath.isEmpty())
+        Trace::ExportChrome(tracePath.toStdString());
+
+    return res;
 }
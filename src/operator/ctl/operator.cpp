@@ -62,7 +62,7 @@ ImageOperator *CTLTransform::OpCreateFromPath(const std::string &filepath) const
     return nullptr;
 }
 
-void CTLTransform::OpApply(Image &img)
+void CTLTransform::OpApply(Image &img) const
 {
     CTLOperations ops;
     ops.push_back({m_ctlFile});
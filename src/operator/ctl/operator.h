@@ -17,7 +17,7 @@ class CTLTransform : public ImageOperator
     ImageOperator *OpCreateFromPath(const std::string &filepath) const override;
     std::string OpName() const override;
     std::string OpLabel() const override;
-    void OpApply(Image &img) override;
+    void OpApply(Image &img) const override;
     bool OpIsIdentity() const override;
     void OpUpdateParamCallback(const Parameter &op) override;
 
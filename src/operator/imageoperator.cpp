@@ -1,13 +1,72 @@
 #include "imageoperator.h"
 
-#include <fstream>
+#include <algorithm>
 
 #include <QtCore/QDebug>
 
 #include <utils/generic.h>
 #include <utils/chrono.h>
-#include <core/imagepipeline.h>
-#include "ocio/filetransform.h"
+#include <utils/parallel.h>
+#include <core/image.h>
+
+
+// Samples of the contrast curves used for isolation, over [0, 1]
+constexpr uint32_t IsolationCurveSize = 8192;
+
+// Applies per-channel curves (planar, IsolationCurveSize samples each) to
+// the RGB channels, inputs are clamped to [0, 1]
+void ApplyCurves(const std::vector<float> &curves, Image &img)
+{
+    const uint32_t n = IsolationCurveSize;
+    uint8_t c = img.channels();
+    uint64_t count = uint64_t(img.width()) * img.height();
+    float *pixels = img.pixels_asfloat();
+
+    ParallelFor(0, count, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+            float *p = pixels + i * c;
+            for (int k = 0; k < std::min<int>(c, 3); ++k) {
+                const float *curve = curves.data() + k * n;
+                float f = std::clamp(p[k], 0.f, 1.f) * (n - 1);
+                uint32_t j = std::min(uint32_t(f), n - 2);
+                float t = f - j;
+                p[k] = curve[j] * (1.f - t) + curve[j + 1] * t;
+            }
+        }
+    }, 4096);
+}
+
+// Inverse of non-decreasing per-channel curves, values outside the curve
+// range map to the domain bounds
+void ApplyInverseCurves(const std::vector<float> &curves, Image &img)
+{
+    const uint32_t n = IsolationCurveSize;
+    uint8_t c = img.channels();
+    uint64_t count = uint64_t(img.width()) * img.height();
+    float *pixels = img.pixels_asfloat();
+
+    ParallelFor(0, count, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+            float *p = pixels + i * c;
+            for (int k = 0; k < std::min<int>(c, 3); ++k) {
+                const float *curve = curves.data() + k * n;
+                const float *it = std::lower_bound(curve, curve + n, p[k]);
+                if (it == curve) {
+                    p[k] = 0.f;
+                }
+                else if (it == curve + n) {
+                    p[k] = 1.f;
+                }
+                else {
+                    uint32_t j = it - curve;
+                    float range = curve[j] - curve[j - 1];
+                    float t = range > 0.f ? (p[k] - curve[j - 1]) / range : 0.f;
+                    p[k] = (j - 1 + t) / (n - 1);
+                }
+            }
+        }
+    }, 4096);
+}
 
 
 ImageOperator::ImageOperator()
@@ -47,57 +106,83 @@ void ImageOperator::UpdatedParameter(const Parameter &p)
     // Order matters here, first give a chance to the operator to update
     // it's internal processing state.
     EmitEvent<Evt::UpdateParam>(p);
+    // Derived state is built from the updated processing
+    UpdateIsolation();
     // Then emit the event that will throw a pipeline update...
     EmitEvent<Evt::Update>();
 }
 
+void ImageOperator::UpdateIsolation()
+{
+    m_contrastCurves.clear();
+    m_contrastInverse.clear();
+
+    bool isolate = m_paramList.Get<SliderParameter>("Contrast")->value() != 100.f
+        || m_paramList.Get<SliderParameter>("Color")->value() != 100.f;
+    if (!isolate)
+        return;
+
+    // Contrast component of the operator, ie. its effect on neutral values
+    const uint32_t n = IsolationCurveSize;
+    Image ramp = Image::Ramp1D(n, 0.0f, 1.0f, RampType::NEUTRAL);
+    OpApply(ramp);
+
+    const float *pix = ramp.pixels_asfloat();
+    m_contrastCurves.resize(n * 3);
+    m_contrastInverse.resize(n * 3);
+    for (int k = 0; k < 3; ++k) {
+        float *curve = m_contrastCurves.data() + k * n;
+        float *inverse = m_contrastInverse.data() + k * n;
+        for (uint32_t i = 0; i < n; ++i) {
+            curve[i] = pix[i * 3 + k];
+            // Inverted as a non-decreasing curve
+            inverse[i] = i ? std::max(inverse[i - 1], curve[i]) : curve[i];
+        }
+    }
+}
+
 bool ImageOperator::IsIdentity() const
 {
     auto enabled = m_paramList.Get<CheckBoxParameter>("Enabled")->value();
     return (!enabled || OpIsIdentity());
 }
 
-void ImageOperator::Apply(Image & img)
+std::string ImageOperator::Fingerprint() const
+{
+    std::string res = OpName();
+    for (auto & p : m_paramList)
+        res += "|" + p->name() + "=" + p->fingerprint();
+    return res + "|" + OpFingerprint();
+}
+
+void ImageOperator::Apply(Image & img) const
 {
+    // Operators process float pixels, other storage types are converted at
+    // the operator boundary
+    if (img.type() != PixelType::Float) {
+        PixelType storage = img.type();
+        Image tmp = img.to_type(PixelType::Float);
+        Apply(tmp);
+        img = tmp.to_type(storage);
+        return;
+    }
+
     float isolate_cts = m_paramList.Get<SliderParameter>("Contrast")->value() / 100.f;
     float isolate_color = m_paramList.Get<SliderParameter>("Color")->value() / 100.f;
 
     const Image img_orig = img;
 
-    if (isolate_cts != 1.0f || isolate_color != 1.0f) {
+    if ((isolate_cts != 1.0f || isolate_color != 1.0f) && !m_contrastCurves.empty()) {
         Image img_apply = img;
         Image img_contrast = img;
         Image img_color = img;
         OpApply(img_apply);
 
-        // Compute 1D LUT, ie. the contrast component of the operator
-        uint32_t lut_1d_size = 8192;
-        Image img_1d = Image::Ramp1D(lut_1d_size, 0.0f, 1.0f, RampType::NEUTRAL);
-        OpApply(img_1d);
-
-        std::string lut_name = "test.spi1d";
-        std::ofstream fs(lut_name);
-        fs << "Version 1\n";
-        fs << "From 0.000000 1.000000\n";
-        fs << "Length " << lut_1d_size << "\n";
-        fs << "Components 3\n";
-        fs << "{\n";
-
-        float *pix = img_1d.pixels_asfloat();
-        for (uint64_t i = 0; i < lut_1d_size; ++i) {
-            fs << pix[i * 3] << "\t" << pix[i * 3 + 1] << "\t" << pix[i * 3 + 2] << "\n";
-        }
-        fs << "}\n";
-        fs.close();
-
         // Image with contrast only applied
-        OCIOFileTransform file_op;
-        file_op.SetFileTransform(lut_name);
-        file_op.OpApply(img_contrast);
+        ApplyCurves(m_contrastCurves, img_contrast);
 
         // Image with color only applied
-        file_op.GetParameter<SelectParameter>("Direction")->setValue("Inverse");
-        file_op.OpApply(img_color);
+        ApplyInverseCurves(m_contrastInverse, img_color);
         OpApply(img_color);
 
         // Mix depending on slider values
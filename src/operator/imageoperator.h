@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 
+#include <core/types.h>
 #include <utils/event_source.h>
 #include <parameter/parameterlist.h>
 
@@ -14,6 +15,14 @@ typedef EventDesc<
 
 class Image;
 
+// Threading contract : an operator is compiled on parameter update. The
+// <UpdateParam> callbacks (OpUpdateParamCallback) build its processing
+// state (processors, LUTs, isolation curves) and nothing else writes it
+// afterwards. Apply and OpApply are const and only read that state, so a
+// single operator can be applied concurrently from several threads
+// (thumbnails, stripes, batch frames). Parameter updates are not
+// synchronized with applies, they must happen on the owning thread while
+// no apply is running.
 class ImageOperator : public EventSource<IOPEvtDesc>
 {
   public:
@@ -34,13 +43,28 @@ class ImageOperator : public EventSource<IOPEvtDesc>
     virtual std::string OpName() const = 0;
     virtual std::string OpLabel() const = 0;
     virtual std::string OpDesc() const { return ""; }
-    virtual void OpApply(Image &img) = 0;
+    virtual void OpApply(Image &img) const = 0;
     virtual bool OpIsIdentity() const { return true; }
+    // Rows needed above and below a stripe of rows to process it, 0 for
+    // pointwise operators. Stripes given to OpApply include these rows.
+    virtual uint32_t OpNeighbourhood() const { return 0; }
+    // Decomposable part of the operator, used to fold operators
+    // algebraically. OpMatrix returns the operator as a row-major 4x4 RGBA
+    // matrix when it is one, per-channel operators (no channel crosstalk)
+    // can be sampled as 1D curves.
+    virtual OptT<Matrix4x4> OpMatrix() const { return {}; }
+    virtual bool OpIsPerChannel() const { return false; }
     virtual void OpUpdateParamCallback(const Parameter &op) {}
+    // Processing state not held by the parameters
+    virtual std::string OpFingerprint() const { return ""; }
 
   public:
     bool IsIdentity() const;
-    void Apply(Image &img);
+    void Apply(Image &img) const;
+
+    // Identifies the operator processing (type, parameter values and
+    // referenced files), equal fingerprints give equal results
+    std::string Fingerprint() const;
 
   public:
     template <typename T, typename... P> T* AddParameter(P&&... p);
@@ -55,12 +79,24 @@ class ImageOperator : public EventSource<IOPEvtDesc>
     std::string DefaultCategory() const;
     CategoryMapT const & Categories() const;
 
+  protected:
+    // Rebuilds the isolation curves from the operator processing, done on
+    // each parameter update. Operators changing their processing outside
+    // of parameter callbacks call it afterwards.
+    void UpdateIsolation();
+
   private:
     void UpdatedParameter(const Parameter &p);
 
   private:
     ParameterList m_paramList;
 
+    // Contrast component of the operator as planar RGB curves, and its
+    // non-decreasing version used for the inverse (Contrast / Color
+    // isolation)
+    std::vector<float> m_contrastCurves;
+    std::vector<float> m_contrastInverse;
+
     CategoryMapT m_categoryMap;
     std::string m_defaultCategory = "Global";
 };
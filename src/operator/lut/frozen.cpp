@@ -0,0 +1,104 @@
+#include "frozen.h"
+
+#include <sstream>
+
+#include <QtCore/QDebug>
+
+#include <core/image.h>
+
+
+FrozenOperator::FrozenOperator()
+{
+    // Frozen chains usually process scene-linear data, a Linear shaper would
+    // clip values above 1
+    AddParameterByCategory<SliderParameter>("LUT", "LUT Size", 33.f, 2.f, 129.f, 1.f);
+    AddParameterByCategory<SelectParameter>("LUT", "Shaper", std::vector<std::string>{"Linear", "Log2"}, "Log2");
+}
+
+ImageOperator *FrozenOperator::OpCreate() const
+{
+    return new FrozenOperator();
+}
+
+std::string FrozenOperator::OpName() const
+{
+    return "Frozen";
+}
+
+std::string FrozenOperator::OpLabel() const
+{
+    std::string label = "Frozen -";
+    for (size_t i = 0; i < m_operators.size(); ++i)
+        label += (i ? ", " : " ") + m_operators[i]->OpLabel();
+    return label;
+}
+
+std::string FrozenOperator::OpDesc() const
+{
+    std::ostringstream oStr;
+    oStr << "Frozen operators (" << m_lut.size() << "^3 LUT)\n";
+    for (auto & op : m_operators)
+        oStr << "\n" << op->OpLabel();
+    return oStr.str();
+}
+
+void FrozenOperator::OpApply(Image &img) const
+{
+    m_lut.apply(img);
+}
+
+bool FrozenOperator::OpIsIdentity() const
+{
+    return !m_lut;
+}
+
+void FrozenOperator::OpUpdateParamCallback(const Parameter &op)
+{
+    if (op.name() == "LUT Size" || op.name() == "Shaper")
+        Bake();
+}
+
+std::string FrozenOperator::OpFingerprint() const
+{
+    std::string res;
+    for (auto & op : m_operators)
+        res += "[" + op->Fingerprint() + "]";
+    return res;
+}
+
+void FrozenOperator::Freeze(UPtrV<ImageOperator> &&operators)
+{
+    m_operators = std::move(operators);
+    Bake();
+    UpdateIsolation();
+}
+
+UPtrV<ImageOperator> FrozenOperator::Unfreeze()
+{
+    UPtrV<ImageOperator> operators = std::move(m_operators);
+    m_operators.clear();
+    m_lut = LUT3D();
+    UpdateIsolation();
+    return operators;
+}
+
+const LUT3D &FrozenOperator::LUT() const
+{
+    return m_lut;
+}
+
+void FrozenOperator::Bake()
+{
+    if (m_operators.empty())
+        return;
+
+    uint32_t size = GetParameter<SliderParameter>("LUT Size")->value();
+    LUTShaper shaper = GetParameter<SelectParameter>("Shaper")->value() == "Log2"
+        ? LUTShaper::Log2 : LUTShaper::Linear;
+
+    m_lut = LUT3D::Bake([this](Image &img) {
+        for (auto & op : m_operators)
+            if (!op->IsIdentity())
+                op->Apply(img);
+    }, size, shaper);
+}
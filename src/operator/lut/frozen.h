@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+#include <core/lut.h>
+#include "../imageoperator.h"
+
+
+class Image;
+
+// A contiguous range of operators baked in a single 3D LUT. The original
+// operators are kept so the range can be unfrozen, and the LUT is only baked
+// again when its size or shaper changes.
+class FrozenOperator : public ImageOperator
+{
+  public:
+    FrozenOperator();
+
+  public:
+    ImageOperator *OpCreate() const override;
+    std::string OpName() const override;
+    std::string OpLabel() const override;
+    std::string OpDesc() const override;
+    void OpApply(Image &img) const override;
+    bool OpIsIdentity() const override;
+    void OpUpdateParamCallback(const Parameter &op) override;
+    std::string OpFingerprint() const override;
+
+  public:
+    void Freeze(UPtrV<ImageOperator> &&operators);
+    UPtrV<ImageOperator> Unfreeze();
+
+    const LUT3D &LUT() const;
+
+  private:
+    void Bake();
+
+  private:
+    UPtrV<ImageOperator> m_operators;
+    LUT3D m_lut;
+};
@@ -21,8 +21,6 @@ OCIOColorSpace::OCIOColorSpace()
     AddParameterByCategory<SelectParameter>("Color Space", "Look");
     AddParameterByCategory<SelectParameter>("Color Space", "Direction", std::vector<std::string>{"Forward", "Inverse"});
 
-    m_config = OCIO::GetCurrentConfig();
-    m_processor = OCIO::Processor::Create();
     m_transform = OCIO::LookTransform::Create();
 }
 
@@ -64,19 +62,14 @@ std::string OCIOColorSpace::OpDesc() const
     return oStr.str();
 }
 
-void OCIOColorSpace::OpApply(Image & img)
+OCIO::ConstTransformRcPtr OCIOColorSpace::OpTransform() const
 {
-    try {
-        OCIO::PackedImageDesc imgDesc(img.pixels_asfloat(), img.width(), img.height(), img.channels());
-        m_processor->apply(imgDesc);
-    } catch (OCIO::Exception &exception) {
-        qWarning() << "OpenColorIO Process Error: " << exception.what() << "\n";
-    }
+    return m_transform;
 }
 
-bool OCIOColorSpace::OpIsIdentity() const
+bool OCIOColorSpace::OpNeedsConfig() const
 {
-    return m_processor->isNoOp();
+    return true;
 }
 
 void OCIOColorSpace::OpUpdateParamCallback(const Parameter & op)
@@ -4,12 +4,12 @@
 
 #include <OpenColorIO/OpenColorIO.h>
 
-#include "../imageoperator.h"
+#include "operator.h"
 
 
 class Image;
 
-class OCIOColorSpace : public ImageOperator
+class OCIOColorSpace : public OCIOOperator
 {
   public:
     OCIOColorSpace();
@@ -20,14 +20,12 @@ class OCIOColorSpace : public ImageOperator
     std::string OpName() const override;
     std::string OpLabel() const override;
     std::string OpDesc() const override;
-    void OpApply(Image &img) override;
-    bool OpIsIdentity() const override;
     void OpUpdateParamCallback(const Parameter &op) override;
+    OCIO_NAMESPACE::ConstTransformRcPtr OpTransform() const override;
+    bool OpNeedsConfig() const override;
 
     void SetConfig(const std::string &configpath);
 
   private:
-    OCIO_NAMESPACE::ConstConfigRcPtr m_config;
-    OCIO_NAMESPACE::ConstProcessorRcPtr m_processor;
     OCIO_NAMESPACE::LookTransformRcPtr m_transform;
 };
\ No newline at end of file
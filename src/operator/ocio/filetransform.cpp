@@ -8,6 +8,7 @@
 
 #include <core/image.h>
 #include <core/imagepipeline.h>
+#include <core/lutio.h>
 #include <utils/chrono.h>
 
 namespace OCIO = OCIO_NAMESPACE;
@@ -17,8 +18,6 @@ OCIOFileTransform::OCIOFileTransform()
 {
     OCIO::ClearAllCaches();
 
-    m_config = OCIO::GetCurrentConfig();
-    m_processor = OCIO::Processor::Create();
     m_transform = OCIO::FileTransform::Create();
 
     QStringList exts = SupportedExtensions();
@@ -27,6 +26,7 @@ OCIOFileTransform::OCIOFileTransform()
     AddParameterByCategory<FilePathParameter>("File", "LUT", "", "Choose a LUT", filter.toStdString());
     AddParameterByCategory<SelectParameter>("File", "Interpolation", std::vector<std::string>{"Best", "Nearest", "Linear", "Tetrahedral"}, "Best");
     AddParameterByCategory<SelectParameter>("File", "Direction", std::vector<std::string>{"Forward", "Inverse"}, "Forward");
+    AddParameterByCategory<SelectParameter>("File", "Lattice Size", std::vector<std::string>{"Native", "17", "33", "65"}, "Native");
 
     // Initialize transform with default parameters
     auto interp = GetParameter<SelectParameter>("Interpolation");
@@ -75,27 +75,38 @@ std::string OCIOFileTransform::OpDesc() const
     return oStr.str();
 }
 
-void OCIOFileTransform::OpApply(Image & img)
+void OCIOFileTransform::OpApply(Image & img) const
 {
     Chrono c;
     c.start();
 
-    OverrideInterpolation();
-
-    try {
-        OCIO::PackedImageDesc imgDesc(img.pixels_asfloat(), img.width(), img.height(), img.channels());
-        m_processor->apply(imgDesc);
-    } catch (OCIO::Exception &exception) {
-        qWarning() << "OpenColorIO Process Error: " << exception.what() << "\n";
-    }
+    if (m_lut)
+        m_lut.apply(img);
+    else
+        OCIOOperator::OpApply(img);
 
     qInfo() << "OCIOFileTransform apply - " << fixed << qSetRealNumberPrecision(2)
-            << c.ellapsed(Chrono::MILLISECONDS) / 1000.f << "sec.\n";
+            << c.ellapsed(Chrono::MILLISECONDS) << "msec.\n";
 }
 
 bool OCIOFileTransform::OpIsIdentity() const
 {
-    return m_processor->isNoOp();
+    return !m_lut && OCIOOperator::OpIsIdentity();
+}
+
+bool OCIOFileTransform::OpIsPerChannel() const
+{
+    return !m_lut && OCIOOperator::OpIsPerChannel();
+}
+
+OCIO::ConstTransformRcPtr OCIOFileTransform::OpTransform() const
+{
+    return m_transform;
+}
+
+bool OCIOFileTransform::OpFoldable() const
+{
+    return !m_lut;
 }
 
 void OCIOFileTransform::OpUpdateParamCallback(const Parameter & op)
@@ -115,8 +126,13 @@ void OCIOFileTransform::OpUpdateParamCallback(const Parameter & op)
             auto p = static_cast<const SelectParameter *>(&op);
             m_transform->setDirection(OCIO::TransformDirectionFromString(p->value().c_str()));
         }
+        // Generic parameters (Enabled, Opacity, Contrast, Color) do not
+        // change the LUT, no need to load, parse or bake it again
+        else if (op.name() != "Lattice Size") {
+            return;
+        }
 
-        m_processor = m_config->getProcessor(m_transform);
+        UpdateProcessor();
     } catch (OCIO::Exception &exception) {
         // When setup has failed, reset processor
         m_processor = OCIO::Processor::Create();
@@ -142,7 +158,8 @@ void OCIOFileTransform::SetFileTransform(const std::string &lutpath)
         m_transform->setSrc(lutpath.c_str());
         m_transform->setInterpolation(OCIO::InterpolationFromString(interp->value().c_str()));
         m_transform->setDirection(OCIO::TransformDirectionFromString(dir->value().c_str()));
-        m_processor = m_config->getProcessor(m_transform);
+        UpdateProcessor();
+        UpdateIsolation();
 
         qInfo() << "OCIOFileTransform init - (" << QString::fromStdString(lutpath)
                 << ") : " << fixed << qSetRealNumberPrecision(2)
@@ -152,6 +169,11 @@ void OCIOFileTransform::SetFileTransform(const std::string &lutpath)
     }
 }
 
+const LUT3D &OCIOFileTransform::NativeLUT() const
+{
+    return m_lut;
+}
+
 QStringList OCIOFileTransform::SupportedExtensions() const
 {
     QStringList exts;
@@ -171,3 +193,51 @@ void OCIOFileTransform::OverrideInterpolation()
         m_processor = m_config->getProcessor(m_transform);
     }
 }
+
+void OCIOFileTransform::UpdateProcessor()
+{
+    // Plain 3D LUTs applied forward with tetrahedral interpolation are
+    // evaluated natively. .cube files are parsed directly, other formats
+    // are baked at their own lattice size, so nodes are exact, and kept in
+    // a binary cache : OCIO only parses them when the cache is missing or
+    // stale.
+    m_lut = LUT3D();
+
+    std::string path = m_transform->getSrc();
+    std::string interp = GetParameter<SelectParameter>("Interpolation")->value();
+    std::string dir = GetParameter<SelectParameter>("Direction")->value();
+    bool native = dir == "Forward" && (interp == "Best" || interp == "Tetrahedral");
+
+    if (native) {
+        m_lut = CachedLUT(path);
+        if (!m_lut && LUTFormatFromPath(path) == LUTFormat::Cube)
+            m_lut = ReadCube(path);
+    }
+
+    if (m_lut) {
+        m_processor = OCIO::Processor::Create();
+    }
+    else {
+        m_processor = m_config->getProcessor(m_transform);
+        OverrideInterpolation();
+
+        auto size = native ? ProbeLUT3DSize(path) : OptT<uint32_t>();
+        if (size) {
+            auto process = [this](Image &img) { ApplyProcessor(m_processor, img); };
+            m_lut = LUT3D::Bake(process, *size);
+            CacheLUT(m_lut, path);
+        }
+    }
+
+    // Native LUTs can be brought to a common lattice size, the cache keeps
+    // the source size
+    std::string lattice = GetParameter<SelectParameter>("Lattice Size")->value();
+    if (m_lut && lattice != "Native") {
+        uint32_t size = std::stoul(lattice);
+        if (m_lut.size() != size) {
+            LUT3D lut = m_lut.resample(size);
+            qInfo() << "OCIOFileTransform resample error -" << m_lut.difference(lut) << "\n";
+            m_lut = std::move(lut);
+        }
+    }
+}
@@ -7,12 +7,13 @@
 
 #include <QtCore/QStringList>
 
-#include "../imageoperator.h"
+#include <core/lut.h>
+#include "operator.h"
 
 
 class Image;
 
-class OCIOFileTransform : public ImageOperator
+class OCIOFileTransform : public OCIOOperator
 {
   public:
     OCIOFileTransform();
@@ -23,19 +24,27 @@ class OCIOFileTransform : public ImageOperator
     std::string OpName() const override;
     std::string OpLabel() const override;
     std::string OpDesc() const override;
-    void OpApply(Image &img) override;
+    void OpApply(Image &img) const override;
     bool OpIsIdentity() const override;
+    bool OpIsPerChannel() const override;
     void OpUpdateParamCallback(const Parameter &op) override;
+    OCIO_NAMESPACE::ConstTransformRcPtr OpTransform() const override;
+    bool OpFoldable() const override;
 
   public:
     void SetFileTransform(const std::string &lutpath);
+    // Native 3D LUT, empty when the transform is applied by OCIO
+    const LUT3D &NativeLUT() const;
 
   public:
     QStringList SupportedExtensions() const;
+
+  private:
+    void UpdateProcessor();
     void OverrideInterpolation();
 
   private:
-    OCIO_NAMESPACE::ConstConfigRcPtr m_config;
-    OCIO_NAMESPACE::ConstProcessorRcPtr m_processor;
     OCIO_NAMESPACE::FileTransformRcPtr m_transform;
+    // Native evaluation of plain 3D LUTs, see UpdateProcessor
+    LUT3D m_lut;
 };
\ No newline at end of file
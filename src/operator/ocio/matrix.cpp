@@ -13,8 +13,6 @@ namespace OCIO = OCIO_NAMESPACE;
 
 OCIOMatrix::OCIOMatrix()
 {
-    m_config = OCIO::GetCurrentConfig();
-    m_processor = OCIO::Processor::Create();
     m_transform = OCIO::MatrixTransform::Create();
 
     AddParameterByCategory<MatrixParameter>("Matrix", "Matrix");
@@ -47,19 +45,31 @@ std::string OCIOMatrix::OpDesc() const
     return oStr.str();
 }
 
-void OCIOMatrix::OpApply(Image & img)
+OCIO::ConstTransformRcPtr OCIOMatrix::OpTransform() const
 {
-    try {
-        OCIO::PackedImageDesc imgDesc(img.pixels_asfloat(), img.width(), img.height(), img.channels());
-        m_processor->apply(imgDesc);
-    } catch (OCIO::Exception &exception) {
-        qWarning() << "OpenColorIO Process Error: " << exception.what() << "\n";
-    }
+    return m_transform;
 }
 
-bool OCIOMatrix::OpIsIdentity() const
+OptT<Matrix4x4> OCIOMatrix::OpMatrix() const
 {
-    return m_processor->isNoOp();
+    Matrix4x4 m;
+    float offset[4];
+    m_transform->getValue(m.data(), offset);
+
+    // Affine transforms are not representable
+    for (float o : offset)
+        if (o != 0.f)
+            return {};
+
+    if (m_transform->getDirection() == OCIO::TRANSFORM_DIR_INVERSE) {
+        bool invertible = false;
+        QMatrix4x4 inv = QMatrix4x4(m.data()).inverted(&invertible);
+        if (!invertible)
+            return {};
+        inv.copyDataTo(m.data());
+    }
+
+    return m;
 }
 
 void OCIOMatrix::OpUpdateParamCallback(const Parameter & op)
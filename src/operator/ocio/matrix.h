@@ -4,12 +4,12 @@
 
 #include <OpenColorIO/OpenColorIO.h>
 
-#include "../imageoperator.h"
+#include "operator.h"
 
 
 class Image;
 
-class OCIOMatrix : public ImageOperator
+class OCIOMatrix : public OCIOOperator
 {
 public:
     OCIOMatrix();
@@ -18,13 +18,11 @@ public:
     ImageOperator * OpCreate() const override;
     std::string OpName() const override;
     std::string OpLabel() const override;
-    void OpApply(Image & img) override;
     std::string OpDesc() const override;
-    bool OpIsIdentity() const override;
     void OpUpdateParamCallback(const Parameter & op) override;
+    OCIO_NAMESPACE::ConstTransformRcPtr OpTransform() const override;
+    OptT<Matrix4x4> OpMatrix() const override;
 
 private:
-    OCIO_NAMESPACE::ConstConfigRcPtr m_config;
-    OCIO_NAMESPACE::ConstProcessorRcPtr m_processor;
     OCIO_NAMESPACE::MatrixTransformRcPtr m_transform;
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "operator.h"
+
+#include <QtCore/QDebug>
+
+#include <core/image.h>
+
+namespace OCIO = OCIO_NAMESPACE;
+
+
+OCIOOperator::OCIOOperator()
+{
+    m_config = OCIO::GetCurrentConfig();
+    m_processor = OCIO::Processor::Create();
+}
+
+void OCIOOperator::OpApply(Image & img) const
+{
+    ApplyProcessor(m_processor, img);
+}
+
+bool OCIOOperator::OpIsIdentity() const
+{
+    return m_processor->isNoOp();
+}
+
+bool OCIOOperator::OpIsPerChannel() const
+{
+    return !m_processor->hasChannelCrosstalk();
+}
+
+OCIO::ConstConfigRcPtr OCIOOperator::Config() const
+{
+    return m_config;
+}
+
+void OCIOOperator::ApplyProcessor(const OCIO::ConstProcessorRcPtr &processor, Image &img)
+{
+    try {
+        OCIO::PackedImageDesc imgDesc(img.pixels_asfloat(), img.width(), img.height(), img.channels());
+        processor->apply(imgDesc);
+    } catch (OCIO::Exception &exception) {
+        qWarning() << "OpenColorIO Process Error: " << exception.what() << "\n";
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <OpenColorIO/OpenColorIO.h>
+
+#include "../imageoperator.h"
+
+
+class Image;
+
+// Base of OpenColorIO operators. Each one is fully described by an OCIO
+// transform, so that adjacent operators can be folded in a single processor
+// (see CompiledPipeline).
+class OCIOOperator : public ImageOperator
+{
+  public:
+    OCIOOperator();
+
+  public:
+    void OpApply(Image &img) const override;
+    bool OpIsIdentity() const override;
+    bool OpIsPerChannel() const override;
+
+  public:
+    virtual OCIO_NAMESPACE::ConstTransformRcPtr OpTransform() const = 0;
+
+    // Whether the transform refers to the config content (colorspaces,
+    // looks), config independent operators can be folded with any config.
+    virtual bool OpNeedsConfig() const { return false; }
+
+    // Whether OpApply is exactly the transform processor, so that the
+    // operator can be folded in a group processor
+    virtual bool OpFoldable() const { return true; }
+
+    OCIO_NAMESPACE::ConstConfigRcPtr Config() const;
+
+    static void ApplyProcessor(const OCIO_NAMESPACE::ConstProcessorRcPtr &processor, Image &img);
+
+  protected:
+    OCIO_NAMESPACE::ConstConfigRcPtr m_config;
+    OCIO_NAMESPACE::ConstProcessorRcPtr m_processor;
+};
@@ -32,10 +32,15 @@ ParameterWidget *CheckBoxParameter::newWidget(QWidget * parent)
 
 void CheckBoxParameter::load(const QSettings *setting)
 {
-    setValue(setting->value(QString::fromStdString(name())).toBool());
+    setValue(setting->value(QString::fromStdString(name()), defaultValue()).toBool());
 }
 
 void CheckBoxParameter::save(QSettings *setting) const
 {
     setting->setValue(QString::fromStdString(name()), value());
-}
\ No newline at end of file
+}
+
+std::string CheckBoxParameter::fingerprint() const
+{
+    return m_value ? "1" : "0";
+}
@@ -23,6 +23,7 @@ class CheckBoxParameter : public Parameter
 
     void load(const QSettings *setting) override;
     void save(QSettings *setting) const override;
+    std::string fingerprint() const override;
 
   private:
     bool m_value;
@@ -2,6 +2,8 @@
 #include "widget.h"
 
 #include <QtCore/QSettings>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDateTime>
 
 
 FilePathParameter::FilePathParameter(const std::string &name)
@@ -62,4 +64,14 @@ void FilePathParameter::load(const QSettings *setting)
 void FilePathParameter::save(QSettings *setting) const
 {
     setting->setValue(QString::fromStdString(name()), QString::fromStdString(value()));
-}
\ No newline at end of file
+}
+
+std::string FilePathParameter::fingerprint() const
+{
+    // Files edited in place must give a new fingerprint
+    QFileInfo info(QString::fromStdString(m_value));
+    if (!info.exists())
+        return m_value;
+
+    return m_value + "@" + std::to_string(info.lastModified().toMSecsSinceEpoch());
+}
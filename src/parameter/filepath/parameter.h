@@ -38,6 +38,7 @@ class FilePathParameter : public Parameter
 
     void load(const QSettings *setting) override;
     void save(QSettings *setting) const override;
+    std::string fingerprint() const override;
 
   private:
     std::string m_value;
@@ -1,6 +1,8 @@
 #include "parameter.h"
 #include "widget.h"
 
+#include <sstream>
+
 #include <utils/pystring.h>
 
 
@@ -57,3 +59,12 @@ void MatrixParameter::save(QSettings *setting) const
 
     setting->setValue(QString::fromStdString(name()), QString::fromStdString(valueStr));
 }
+
+std::string MatrixParameter::fingerprint() const
+{
+    std::ostringstream oStr;
+    oStr << std::hexfloat;
+    for (auto v : m_value)
+        oStr << v << " ";
+    return oStr.str();
+}
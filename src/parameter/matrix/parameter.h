@@ -25,6 +25,7 @@ class MatrixParameter : public Parameter
 
     void load(const QSettings *setting) override;
     void save(QSettings *setting) const override;
+    std::string fingerprint() const override;
 
   private:
     Matrix4x4 m_value;
@@ -41,6 +41,9 @@ class Parameter : public EventSource<PEvtDesc>
     virtual void load(const QSettings* setting) = 0;
     virtual void save(QSettings* setting) const = 0;
 
+    // Identifies the current value, used to key cached results
+    virtual std::string fingerprint() const = 0;
+
   protected:
     virtual ParameterWidget *newWidget(QWidget* parent) = 0;
 
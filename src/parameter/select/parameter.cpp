@@ -62,10 +62,16 @@ ParameterWidget *SelectParameter::newWidget(QWidget *parent)
 
 void SelectParameter::load(const QSettings *setting)
 {
-    setValue(setting->value(QString::fromStdString(name())).toString().toStdString());
+    QVariant v = setting->value(QString::fromStdString(name()), QString::fromStdString(defaultValue()));
+    setValue(v.toString().toStdString());
 }
 
 void SelectParameter::save(QSettings *setting) const
 {
     setting->setValue(QString::fromStdString(name()), QString::fromStdString(value()));
-}
\ No newline at end of file
+}
+
+std::string SelectParameter::fingerprint() const
+{
+    return m_value;
+}
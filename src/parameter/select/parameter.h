@@ -30,6 +30,7 @@ class SelectParameter : public Parameter
 
     void load(const QSettings *setting) override;
     void save(QSettings *setting) const override;
+    std::string fingerprint() const override;
 
   private:
     std::string m_value;
@@ -1,6 +1,8 @@
 #include "parameter.h"
 #include "widget.h"
 
+#include <sstream>
+
 #include <QtCore/QSettings>
 
 
@@ -73,10 +75,17 @@ ParameterWidget *SliderParameter::newWidget(QWidget * parent)
 
 void SliderParameter::load(const QSettings *setting)
 {
-    setValue(setting->value(QString::fromStdString(name())).toFloat());
+    setValue(setting->value(QString::fromStdString(name()), defaultValue()).toFloat());
 }
 
 void SliderParameter::save(QSettings *setting) const
 {
     setting->setValue(QString::fromStdString(name()), value());
-}
\ No newline at end of file
+}
+
+std::string SliderParameter::fingerprint() const
+{
+    std::ostringstream oStr;
+    oStr << std::hexfloat << m_value;
+    return oStr.str();
+}
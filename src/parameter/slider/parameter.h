@@ -44,6 +44,7 @@ class SliderParameter : public Parameter
 
     void load(const QSettings *setting) override;
     void save(QSettings *setting) const override;
+    std::string fingerprint() const override;
 
   private:
     float m_value;
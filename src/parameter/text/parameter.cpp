@@ -36,4 +36,9 @@ void TextParameter::load(const QSettings *setting)
 void TextParameter::save(QSettings *setting) const
 {
         setting->setValue(QString::fromStdString(name()), QString::fromStdString(value()));
-}
\ No newline at end of file
+}
+
+std::string TextParameter::fingerprint() const
+{
+    return m_value;
+}
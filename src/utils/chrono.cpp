@@ -1,9 +1,9 @@
 #include "chrono.h"
 
-using namespace std::chrono;
+#include "trace.h"
 
 Chrono::Chrono()
-	: _paused(false)
+	: _current_duration(0), _startTime(Trace::Now()), _paused(false)
 {
 
 }
@@ -16,15 +16,15 @@ Chrono::~Chrono()
 void Chrono::start()
 {
 	// reset chrono if already running
-	_startTime = ClockT::now();
-	_current_duration = DurationT::zero();
+	_startTime = Trace::Now();
+	_current_duration = 0;
 }
 
 void Chrono::pause()
 {
 	if(!_paused)
 	{
-		_current_duration = ClockT::now() - _startTime;
+		_current_duration += Trace::Now() - _startTime;
 		_paused = true;
 	}
 }
@@ -33,7 +33,7 @@ void Chrono::resume()
 {
 	if(_paused == true)
 	{
-		_startTime = ClockT::now();
+		_startTime = Trace::Now();
 		_paused = false;
 	}
 }
@@ -42,8 +42,9 @@ float Chrono::ellapsed(DurationType dt)
 {
 	if(!_paused)
 	{
-		_current_duration += ClockT::now() - _startTime;
-		_startTime = ClockT::now();
+		int64_t now = Trace::Now();
+		_current_duration += now - _startTime;
+		_startTime = now;
 	}
 
 	float ellapsed = 0;
@@ -51,17 +52,17 @@ float Chrono::ellapsed(DurationType dt)
 	switch(dt)
 	{
 		case MINUTES :
-			ellapsed = duration_cast<minutes>(_current_duration).count();
+			ellapsed = _current_duration / 60e9;
 			break;
 		case SECONDS :
-			ellapsed = duration_cast<seconds>(_current_duration).count();
+			ellapsed = _current_duration / 1e9;
 			break;
 		case MILLISECONDS :
-			ellapsed = duration_cast<milliseconds>(_current_duration).count();
+			ellapsed = _current_duration / 1e6;
 			break;
 		case NANOSECONDS :
-			ellapsed = duration_cast<nanoseconds>(_current_duration).count();
+			ellapsed = _current_duration;
 	}
 
 	return ellapsed;
-}
\ No newline at end of file
+}
@@ -1,7 +1,8 @@
 #pragma once
 
-#include <chrono>
+#include <cstdint>
 
+// Stopwatch over the trace clock (see Trace::Now)
 class Chrono
 {
 public:
@@ -17,12 +18,8 @@ public:
 	float ellapsed(DurationType dt = MILLISECONDS);
 
 private:
-	typedef std::chrono::duration<double, std::nano> DurationT;
-	typedef std::chrono::high_resolution_clock ClockT;
-	typedef std::chrono::time_point<ClockT> TimePointT;
-
-	DurationT _current_duration;
-	TimePointT _startTime;
+	int64_t _current_duration;
+	int64_t _startTime;
 
 	bool _paused;
-};
\ No newline at end of file
+};
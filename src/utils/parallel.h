@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <vector>
+
+
+// Splits [begin, end) in contiguous chunks of at least grain elements and
+// calls func(chunkBegin, chunkEnd) for each of them concurrently. Returns
+// once every chunk has been processed.
+template <typename F>
+void ParallelFor(int64_t begin, int64_t end, F func, int64_t grain = 1)
+{
+    int64_t count = end - begin;
+    if (count <= 0)
+        return;
+
+    int64_t workers = std::max(1u, std::thread::hardware_concurrency());
+    int64_t chunks = std::clamp(count / std::max<int64_t>(grain, 1), int64_t(1), workers);
+    if (chunks == 1) {
+        func(begin, end);
+        return;
+    }
+
+    int64_t step = (count + chunks - 1) / chunks;
+
+    std::vector<std::future<void>> tasks;
+    for (int64_t b = begin + step; b < end; b += step)
+        tasks.push_back(std::async(std::launch::async, func, b, std::min(b + step, end)));
+
+    // First chunk on the calling thread
+    func(begin, std::min(begin + step, end));
+
+    for (auto & t : tasks)
+        t.get();
+}
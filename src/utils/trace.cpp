@@ -0,0 +1,156 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+
+// Slots are guarded by a sequence number, odd while being written. Readers
+// drop slots whose sequence changed during the copy.
+struct TraceSlot
+{
+    std::atomic<uint64_t> sequence { 0 };
+    Trace::Event event;
+};
+
+static std::array<TraceSlot, Trace::Capacity> s_slots;
+static std::atomic<uint64_t> s_next { 0 };
+static std::atomic<uint32_t> s_threads { 0 };
+static const auto s_epoch = std::chrono::steady_clock::now();
+
+int64_t Trace::Now()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now() - s_epoch).count();
+}
+
+void Trace::Record(const char *category, const std::string &name, int64_t start, int64_t end)
+{
+    thread_local uint32_t thread = ++s_threads;
+
+    uint64_t index = s_next.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot &slot = s_slots[index % Capacity];
+
+    // Odd sequence while the event is written, the fence keeps the event
+    // writes from moving before it (a release store alone does not)
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Event &e = slot.event;
+    std::strncpy(e.name, name.c_str(), sizeof(e.name) - 1);
+    e.name[sizeof(e.name) - 1] = '\0';
+    e.category = category;
+    e.thread = thread;
+    e.start = start;
+    e.duration = end - start;
+
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<Trace::Event> Trace::Events()
+{
+    uint64_t last = s_next.load(std::memory_order_acquire);
+    uint64_t first = last > Capacity ? last - Capacity : 0;
+
+    std::vector<Event> events;
+    events.reserve(last - first);
+
+    for (uint64_t i = first; i < last; ++i) {
+        const TraceSlot &slot = s_slots[i % Capacity];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * i + 2)
+            continue;
+
+        Event e = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before)
+            events.push_back(e);
+    }
+
+    return events;
+}
+
+std::vector<Trace::Stat> Trace::Stats(const std::string &category)
+{
+    std::map<std::string, std::vector<int64_t>> durations;
+    for (auto & e : Events())
+        if (category == e.category)
+            durations[e.name].push_back(e.duration);
+
+    auto percentile = [](const std::vector<int64_t> &d, float p) {
+        size_t i = std::min(d.size() - 1, size_t(p * d.size()));
+        return d[i] / 1e6f;
+    };
+
+    std::vector<Stat> stats;
+    for (auto & [name, d] : durations) {
+        std::sort(d.begin(), d.end());
+
+        Stat s;
+        s.name = name;
+        s.count = d.size();
+        s.p50 = percentile(d, 0.5f);
+        s.p95 = percentile(d, 0.95f);
+        s.total = 0.f;
+        for (auto v : d)
+            s.total += v / 1e6f;
+        stats.push_back(s);
+    }
+
+    return stats;
+}
+
+bool Trace::ExportChrome(const std::string &path)
+{
+    std::ofstream ofs(path);
+    if (!ofs)
+        return false;
+
+    auto escape = [](const char *s) {
+        std::string res;
+        for (; *s; ++s) {
+            if (*s == '"' || *s == '\\')
+                res += '\\';
+            res += *s;
+        }
+        return res;
+    };
+
+    // Complete events, timestamps in microseconds
+    ofs << std::fixed << std::setprecision(3);
+    ofs << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (auto & e : Events()) {
+        ofs << (first ? "" : ",\n")
+            << "{\"name\":\"" << escape(e.name) << "\",\"cat\":\"" << e.category
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+            << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << e.duration / 1000.0 << "}";
+        first = false;
+    }
+    ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return bool(ofs);
+}
+
+void Trace::Clear()
+{
+    // Cleared slots never match their expected sequence
+    for (auto & slot : s_slots)
+        slot.sequence.store(0);
+}
+
+TraceScope::TraceScope(const char *category, const std::string &name)
+: m_category(category), m_name(name), m_start(Trace::Now())
+{
+
+}
+
+TraceScope::~TraceScope()
+{
+    Trace::Record(m_category, m_name, m_start, Trace::Now());
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// Timed spans recorded in a fixed size ring buffer, oldest spans being
+// overwritten. Recording is lock-free and can happen from any thread.
+// Spans can be exported as a Chrome trace (chrome://tracing, Perfetto) or
+// summarized per name.
+class Trace
+{
+  public:
+    struct Event
+    {
+        char name[48];
+        const char *category;
+        uint32_t thread;
+        int64_t start;      // nanoseconds since process start
+        int64_t duration;   // nanoseconds
+    };
+
+    // Duration percentiles of the spans sharing a name, in msec
+    struct Stat
+    {
+        std::string name;
+        uint32_t count;
+        float p50;
+        float p95;
+        float total;
+    };
+
+    static constexpr uint32_t Capacity = 1 << 16;
+
+  public:
+    // Monotonic clock, in nanoseconds since process start
+    static int64_t Now();
+
+    // Categories must be string literals
+    static void Record(const char *category, const std::string &name, int64_t start, int64_t end);
+
+    // Recorded spans, oldest first
+    static std::vector<Event> Events();
+    static std::vector<Stat> Stats(const std::string &category);
+    static bool ExportChrome(const std::string &path);
+    static void Clear();
+};
+
+// Records a span from construction to destruction
+class TraceScope
+{
+  public:
+    TraceScope(const char *category, const std::string &name);
+    ~TraceScope();
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope& operator=(const TraceScope &) = delete;
+
+  private:
+    const char *m_category;
+    std::string m_name;
+    int64_t m_start;
+};